@@ -116,6 +116,50 @@ namespace rs
             */
             bool is_real_time();
 
+            /**
+            * @brief Sets the number of frames which are read ahead and decoded in parallel
+            *
+            * The frames are read from the file by the playback read thread, and decoded by a pool of worker threads.
+            * The samples are delivered to the application in the file order, as in the default mode.
+            * A larger lookahead enables real time playback of files which their frames decode slower than the capture frame rate, at the cost of memory for the decoded frames.
+            * The default lookahead is 0, in which the frames are decoded by the read thread, one frame at a time.
+            * The function can be called while the playback is paused or playing. The call waits for the frames that are decoded by the previous
+            * decode threads, the frames which are read after the call are decoded with the new settings.
+            * @param[in] frames_count   The maximal number of frames which are decoded ahead of the delivered frames, 0 disables the worker threads.
+            * @param[in] threads_count  The number of decode threads, 0 sets one thread per hardware thread.
+            */
+            void set_decode_lookahead(uint32_t frames_count, uint32_t threads_count = 0);
+
+            /**
+            * @brief Enables or disables writing the samples index cache of the file
+            *
+            * Files which were not finalized by the recording, and files of version 2, are indexed by reading all of their samples when they are opened.
+            * To open such a file faster the next time, the index is saved aside the file, to <file path>.idx, when the device is destroyed.
+            * The cache is used only while the file size and modification time match the ones which the cache was built for.
+            * Disable the cache when the file directory isn't writable or shouldn't be modified. The cache is enabled by default.
+            * @param[in] enabled  True to write the index cache when the device is destroyed, false to leave the file directory unchanged.
+            */
+            void set_index_cache(bool enabled);
+
+            /**
+            * @brief Sets the playback speed, relative to the capture time of the samples
+            *
+            * The speed applies to real time mode, in which the samples are delivered when their capture time, divided by the speed, elapses on the playback clock.
+            * A speed change takes effect from the current sample, the samples which were already delivered are not affected.
+            * Non-real time mode ignores the playback speed. The default speed is 1.
+            * @param[in] speed  The requested speed, in the range of 0.1 to 16.
+            * @return bool      True if the speed was set, false if the speed is out of range.
+            */
+            bool set_playback_speed(double speed);
+
+            /**
+            * @brief Gets the playback speed
+            *
+            * For more details see rs::playback::device::set_playback_speed method.
+            * @return double    The playback speed.
+            */
+            double get_playback_speed();
+
             /**
             * @brief Gets the total frame count of the requested stream captured in the file.
             *
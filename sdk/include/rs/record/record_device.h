@@ -14,7 +14,42 @@ namespace rs
             disabled  = 0,
             low       = 1,
             medium    = 2,
-            high      = 3
+            high      = 3,
+            adaptive  = 4  /**< Lossless streams are compressed faster while the record falls behind, and tighter when there is headroom. */
+        };
+
+        /** @brief The record behavior when the queue of samples waiting to be written reaches the memory budget. */
+        enum back_pressure_policy
+        {
+            drop_newest = 0,    /**< The new sample is dropped */
+            drop_oldest = 1,    /**< The oldest queued samples are dropped to make room for the new sample */
+            block       = 2     /**< The caller is blocked until enough queued samples are written */
+        };
+
+        /** @brief The state of the queue of samples waiting to be written to the file. */
+        struct queue_status
+        {
+            uint64_t queued_bytes;          /**< Memory currently held by queued samples */
+            uint64_t peak_queued_bytes;     /**< The highest value of queued_bytes since record start */
+            uint64_t dropped_samples;       /**< Number of frames and motion samples that were dropped */
+            uint64_t dropped_bytes;         /**< Memory of the dropped samples */
+            uint64_t ring_bytes;            /**< Memory currently held by the ring buffer samples, see set_ring_buffer_duration */
+        };
+
+        /** @brief The record counters of a single stream, accumulated since record start. */
+        struct stream_statistics
+        {
+            uint64_t frames_received;       /**< Frames passed to the record, including the dropped frames */
+            uint64_t frames_written;        /**< Frames written to file */
+            uint64_t frames_dropped;        /**< Frames dropped by the back pressure policy */
+            uint64_t bytes_in;              /**< Raw image size of the written frames */
+            uint64_t bytes_out;             /**< Image data size written to file, bytes_in / bytes_out is the compression ratio */
+            uint64_t queued_frames;         /**< Frames currently waiting to be compressed or written */
+            double   encode_time_p50;       /**< Median frame compression time in milliseconds */
+            double   encode_time_p90;       /**< 90th percentile of the frame compression time in milliseconds */
+            double   encode_time_p99;       /**< 99th percentile of the frame compression time in milliseconds */
+            double   average_latency;       /**< Average time from the frame arrival to its write to file, in milliseconds */
+            double   max_latency;           /**< The longest time from the frame arrival to its write to file, in milliseconds */
         };
 
         /**
@@ -59,7 +94,9 @@ namespace rs
             *
             * The function can be called only before record device start is called. The call is ignored while record device is in streaming state.
             * Setting the compression level adjusts the recorded file size - higher level creates smaller file and increase the CPU utilization.
+            * Streams are compressed losslessly, unless lossy compression is enabled for the stream by set_lossy_compression.
             * The default compression level is high, if no other level setting is done by the user..
+            * With adaptive level, the compression speed follows the record queue depth and the compression time, to keep up with the captured frames rather than drop them.
             * Disable the compression is done by set compression_level to disabled
             * @param[in] stream  The stream for which the compression properties are requested.
             * @param[in] compression_level  The requsted compression level.
@@ -76,6 +113,146 @@ namespace rs
             * @return compression_level The current compression level of the requested stream;
             */
             compression_level get_compression_level(rs::stream stream);
+
+            /**
+            * @brief Compress the selected color stream with a lossy intra frame codec.
+            *
+            * The function can be called only before record device start is called. The call is ignored while record device is in streaming state.
+            * Lossy compression records much smaller files, but the played back frames are not identical to the captured frames.
+            * Each frame is encoded as JPEG, the compression level sets the quality - 95 for low, 85 for medium and adaptive, and 75 for high.
+            * Lossy compression applies to RGB8 and BGR8 streams, other formats, including formats with an alpha channel, are compressed losslessly.
+            * Lossy compression is disabled by default, and has no effect if the stream compression level is disabled.
+            * @param[in] stream  The stream for which lossy compression is requested.
+            * @param[in] enabled  True to compress the stream with the lossy codec, false to compress it losslessly.
+            * @return core::status
+            * status_no_error               Successful execution.
+            * status_exec_aborted           The device is in streaming state.
+            */
+            core::status set_lossy_compression(rs::stream stream, bool enabled);
+
+            /**
+            * @brief Set the number of threads used to compress the recorded frames.
+            *
+            * The function can be called only before record device start is called. The call is ignored while record device is in streaming state.
+            * Frames are compressed concurrently and written to the file in capture order, the file layout doesn't depend on the number of threads.
+            * The default value is 0, which sets one thread per enabled stream, bounded by the number of hardware threads.
+            * @param[in] threads_count  The requested number of compression threads.
+            * @return core::status
+            * status_no_error               Successful execution.
+            * status_exec_aborted           The device is in streaming state.
+            */
+            core::status set_compression_threads_count(uint32_t threads_count);
+
+            /**
+            * @brief Set the number of row stripes each losslessly compressed frame is split to.
+            *
+            * The function can be called only before record device start is called. The call is ignored while record device is in streaming state.
+            * Stripes are compressed independently, so playback can decompress the stripes of a frame concurrently.
+            * Splitting a frame slightly increases the recorded file size. Depth and lossy compressed color frames are not split.
+            * The default value is 1, each frame is compressed as a single block.
+            * @param[in] stripes_count  The requested number of stripes, up to 64.
+            * @return core::status
+            * status_no_error               Successful execution.
+            * status_invalid_argument       Stripes count is out of legal range.
+            * status_exec_aborted           The device is in streaming state.
+            */
+            core::status set_compression_stripes_count(uint32_t stripes_count);
+
+            /**
+            * @brief Set the memory budget of the samples waiting to be written and the behavior when the budget is reached.
+            *
+            * The function can be called only before record device start is called. The call is ignored while record device is in streaming state.
+            * All streams and motion samples share the same budget. The default budget is 100MB per stream with drop_newest policy.
+            * @param[in] max_queued_bytes  The memory budget in bytes, 0 sets the default budget.
+            * @param[in] policy  The requested back pressure policy.
+            * @return core::status
+            * status_no_error               Successful execution.
+            * status_invalid_argument       Policy value is out of legal range.
+            * status_exec_aborted           The device is in streaming state.
+            */
+            core::status set_memory_budget(uint64_t max_queued_bytes, back_pressure_policy policy);
+
+            /**
+            * @brief Get the state of the queue of samples waiting to be written.
+            *
+            * The function can be called while streaming, to monitor the record memory consumption and samples drop.
+            * @return queue_status The current queued bytes and the accumulated drop counters.
+            */
+            queue_status get_queue_status();
+
+            /**
+            * @brief Get the record counters of the selected stream.
+            *
+            * The function can be called while streaming, to monitor the record throughput, compression and latency of each stream.
+            * Compression time percentiles are measured with a 25% resolution. With a ring buffer, frames are written to file when the ring is dumped.
+            * @param[in] stream  The stream for which the statistics are requested.
+            * @return stream_statistics The counters of the requested stream, all zero if the stream is not recorded.
+            */
+            stream_statistics get_stream_statistics(rs::stream stream);
+
+            /**
+            * @brief Split the recording to segment files of limited size or duration.
+            *
+            * The function can be called only before record device start is called. The call is ignored while record device is in streaming state.
+            * When a limit is set, the record is written to segment files named by the file path with a running index before the extension,
+            * for example record.rssdk is recorded to record_00000.rssdk, record_00001.rssdk and so on.
+            * A new segment is started when the current segment reaches any of the limits. No sample is dropped at the segment boundary,
+            * and each segment is a self contained file which can be played back separately.
+            * Both limits are 0 by default, which records a single file.
+            * @param[in] max_segment_size  The segment size in bytes, 0 for no size limit.
+            * @param[in] max_segment_duration  The segment duration in milliseconds, 0 for no duration limit.
+            * @return core::status
+            * status_no_error               Successful execution.
+            * status_exec_aborted           The device is in streaming state.
+            */
+            core::status set_segment_limits(uint64_t max_segment_size, uint64_t max_segment_duration);
+
+            /**
+            * @brief Set how the record files are written to disk.
+            *
+            * The function can be called only before record device start is called. The call is ignored while record device is in streaming state.
+            * The options are supported on Linux only, and ignored on other platforms.
+            * Direct io bypasses the page cache, so a long recording doesn't evict the page cache of other processes.
+            * It falls back to cached writes on file systems which don't support it. Direct io is disabled by default.
+            * Preallocation reserves the file disk space in steps of the preallocation size, which reduces the file system fragmentation.
+            * The space reserved beyond the end of the file is released when the file is closed. The default preallocation size is 64MB.
+            * @param[in] direct_io  Write the files with direct io.
+            * @param[in] preallocation_size  The preallocation step in bytes, 0 to disable preallocation.
+            * @return core::status
+            * status_no_error               Successful execution.
+            * status_exec_aborted           The device is in streaming state.
+            */
+            core::status set_file_write_options(bool direct_io, uint64_t preallocation_size);
+
+            /**
+            * @brief Keep only the last samples in memory, and write them to file when triggered.
+            *
+            * The function can be called only before record device start is called. The call is ignored while record device is in streaming state.
+            * When the duration is set, the compressed samples of the last duration are kept in a memory ring and nothing is written to disk,
+            * until trigger_ring_buffer_dump is called. Each trigger writes a file named as the segment files of set_segment_limits.
+            * The segment limits are ignored while a ring buffer is used. The default duration is 0, which records all samples to file.
+            * The ring memory is bounded by its size as well, when the ring exceeds the size the oldest samples are removed, and the ring holds a shorter duration.
+            * Frames which are not compressed are kept in the ring at their full size. The ring memory is separate from the memory budget of the queued samples.
+            * @param[in] duration  The duration of the samples kept in memory in milliseconds, 0 to disable the ring buffer.
+            * @param[in] max_size  The memory held by the ring in bytes, 0 sets the memory budget of set_memory_budget.
+            * @return core::status
+            * status_no_error               Successful execution.
+            * status_exec_aborted           The device is in streaming state.
+            */
+            core::status set_ring_buffer_duration(uint64_t duration, uint64_t max_size = 0);
+
+            /**
+            * @brief Write the ring buffer samples to a new file.
+            *
+            * The samples kept in the ring buffer are written to file, followed by the samples captured up to the post trigger duration after the trigger.
+            * A trigger that is called while the previous trigger samples are still written extends the same file.
+            * @param[in] post_trigger_duration  The duration of the samples recorded after the trigger in milliseconds.
+            * @return core::status
+            * status_no_error               Successful execution.
+            * status_feature_unsupported    The ring buffer is not enabled.
+            * status_exec_aborted           The device is not in streaming state.
+            */
+            core::status trigger_ring_buffer_dump(uint64_t post_trigger_duration);
         };
     }
 }
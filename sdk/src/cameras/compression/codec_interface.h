@@ -5,6 +5,7 @@
 #include <memory>
 #include "rs/core/status.h"
 #include "include/file_types.h"
+#include "include/buffer_pool.h"
 
 namespace rs
 {
@@ -20,7 +21,25 @@ namespace rs
 
                 virtual file_types::compression_type get_compression_type() = 0;
                 virtual status encode(file_types::frame_info &info, const uint8_t * input, uint8_t * output, uint32_t &output_size) = 0;
-                virtual std::shared_ptr<file_types::frame_sample> decode(std::shared_ptr<file_types::frame_sample> frame, uint8_t * input, uint32_t input_size) = 0;
+                virtual std::shared_ptr<file_types::frame_sample> decode(std::shared_ptr<file_types::frame_sample> frame, const uint8_t * input, uint32_t input_size) = 0;
+                //trade compression ratio for encode speed while recording, may be called concurrently with encode
+                virtual void set_acceleration(int acceleration) {}
+                //the number of released decoded frame buffers which are kept for reuse
+                void set_max_free_frames(size_t max_free_frames) { m_frames_buffer_pool.set_max_free_buffers(max_free_frames); }
+
+            protected:
+                //the decoded frame data is a recycled buffer, which returns to the codec pool when the frame is released
+                std::shared_ptr<file_types::frame_sample> create_decoded_frame(const std::shared_ptr<file_types::frame_sample> & frame, size_t size, uint8_t *& data)
+                {
+                    auto buffer = m_frames_buffer_pool.acquire(size);
+                    auto rv = std::shared_ptr<file_types::frame_sample>(
+                    new file_types::frame_sample(frame.get()), [buffer](file_types::frame_sample* f) { delete f; });
+                    data = buffer.get();
+                    rv->data = data;
+                    return rv;
+                }
+
+                core::buffer_pool m_frames_buffer_pool;
             };
         }
     }
@@ -3,6 +3,9 @@
 
 #include "decoder.h"
 #include "lz4_codec.h"
+#include "z16_codec.h"
+#include "jpeg_codec.h"
+#include "striped_lz4_codec.h"
 #include "rs/utils/log_utils.h"
 #include "rs_sdk_version.h"
 
@@ -33,17 +36,27 @@ namespace rs
                 switch (compression_type)
                 {
                     case file_types::compression_type::lz4: codec   = std::shared_ptr<codec_interface>(new lz4_codec()); break;
+                    case file_types::compression_type::z16_lz4: codec = std::shared_ptr<codec_interface>(new z16_codec()); break;
+                    case file_types::compression_type::jpeg: codec  = std::shared_ptr<codec_interface>(new jpeg_codec()); break;
+                    case file_types::compression_type::lz4_striped: codec = std::shared_ptr<codec_interface>(new striped_lz4_codec()); break;
                     default: codec                                  = nullptr; break;
                 }
             }
 
-            std::shared_ptr<file_types::frame_sample> decoder::decode_frame(std::shared_ptr<file_types::frame_sample> frame, uint8_t *input, uint32_t input_size)
+            void decoder::set_max_free_frames(size_t max_free_frames)
+            {
+                for(auto & codec : m_codecs)
+                    if(codec.second)
+                        codec.second->set_max_free_frames(max_free_frames);
+            }
+
+            std::shared_ptr<file_types::frame_sample> decoder::decode_frame(std::shared_ptr<file_types::frame_sample> frame, const uint8_t * input, uint32_t input_size)
             {
                 LOG_FUNC_SCOPE();
                 if(!frame)
                     return nullptr;
                 auto codec = m_codecs.at(frame->finfo.stream);
-                return codec ? m_codecs[frame->finfo.stream]->decode(frame, input, input_size) : nullptr;
+                return codec ? codec->decode(frame, input, input_size) : nullptr;
             }
         }
     }
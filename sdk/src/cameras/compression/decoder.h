@@ -19,7 +19,9 @@ namespace rs
                 decoder(std::map<rs_stream,file_types::compression_type> configuration);
                 ~decoder();
 
-                std::shared_ptr<file_types::frame_sample> decode_frame(std::shared_ptr<file_types::frame_sample> frame, uint8_t * input, uint32_t input_size);
+                std::shared_ptr<file_types::frame_sample> decode_frame(std::shared_ptr<file_types::frame_sample> frame, const uint8_t * input, uint32_t input_size);
+                //the number of released decoded frame buffers which are kept for reuse, per stream
+                void set_max_free_frames(size_t max_free_frames);
 
             private:
                 void add_codec(rs_stream stream_type, file_types::compression_type compression_type);
@@ -1,9 +1,16 @@
 // License: Apache 2.0. See LICENSE file in root directory.
 // Copyright(c) 2016 Intel Corporation. All Rights Reserved.
 
+#include <cmath>
+#include <algorithm>
+#include <chrono>
 #include "encoder.h"
 #include "lz4_codec.h"
+#include "z16_codec.h"
+#include "jpeg_codec.h"
+#include "striped_lz4_codec.h"
 #include "rs/utils/log_utils.h"
+#include "lz4.h"
 
 namespace rs
 {
@@ -11,6 +18,7 @@ namespace rs
     {
         namespace compression
         {
+            const double encoder::ENCODE_TIME_GROWTH = 1.25;
 
             encoder::encoder()
             {
@@ -27,32 +35,102 @@ namespace rs
                 if(m_codecs.find(stream) != m_codecs.end())
                 {
                     auto codec = m_codecs.at(stream);
-                    return codec ? m_codecs[stream]->get_compression_type() : file_types::compression_type::none;
+                    return codec ? codec->get_compression_type() : file_types::compression_type::none;
                 }
                 return file_types::compression_type::none;
             }
 
-            file_types::compression_type encoder::compression_policy(rs_stream stream, rs_format format)
+            uint32_t encoder::get_max_encoded_size(const file_types::frame_info &info)
             {
-                return file_types::compression_type::lz4;
+                return static_cast<uint32_t>(LZ4_compressBound(info.stride * info.height)) + striped_lz4_codec::get_max_overhead();
             }
 
-            void encoder::add_codec(rs_stream stream, rs_format format, record::compression_level compression_level)
+            file_types::compression_type encoder::compression_policy(rs_stream stream, rs_format format, bool is_lossy, uint32_t stripes_count)
+            {
+                if(format == rs_format::RS_FORMAT_Z16)
+                    return file_types::compression_type::z16_lz4;
+                if(is_lossy && jpeg_codec::is_format_supported(format))
+                    return file_types::compression_type::jpeg;
+                return stripes_count > 1 ? file_types::compression_type::lz4_striped : file_types::compression_type::lz4;
+            }
+
+            void encoder::add_codec(rs_stream stream, rs_format format, record::compression_level compression_level, bool is_lossy, uint32_t stripes_count)
             {
                 if(m_codecs.find(stream) != m_codecs.end()) return;
                 auto & codec = m_codecs[stream];
-                switch (compression_policy(stream, format))
+                switch (compression_policy(stream, format, is_lossy, stripes_count))
                 {
                     case file_types::compression_type::lz4: codec   = std::shared_ptr<codec_interface>(new lz4_codec(compression_level)); break;
+                    case file_types::compression_type::z16_lz4: codec = std::shared_ptr<codec_interface>(new z16_codec(compression_level)); break;
+                    case file_types::compression_type::jpeg: codec  = std::shared_ptr<codec_interface>(new jpeg_codec(compression_level)); break;
+                    case file_types::compression_type::lz4_striped: codec = std::shared_ptr<codec_interface>(new striped_lz4_codec(compression_level, stripes_count)); break;
                     default: codec                                  = nullptr; break;
                 }
+                if(codec && compression_level == record::compression_level::adaptive)
+                    m_adaptive_codecs.push_back(codec);
+                if(codec)
+                {
+                    auto & encode_times = m_encode_times[stream];
+                    encode_times.reset(new encode_time_histogram());
+                    for(auto & bucket : *encode_times)
+                        bucket = 0;
+                }
+            }
+
+            int encoder::get_max_acceleration()
+            {
+                return lz4_codec::get_acceleration(record::compression_level::low);
+            }
+
+            bool encoder::is_adaptive(rs_stream stream)
+            {
+                auto codec = m_codecs.find(stream);
+                if(codec == m_codecs.end() || !codec->second) return false;
+                return std::find(m_adaptive_codecs.begin(), m_adaptive_codecs.end(), codec->second) != m_adaptive_codecs.end();
+            }
+
+            void encoder::set_acceleration(int acceleration)
+            {
+                for(auto & codec : m_adaptive_codecs)
+                    codec->set_acceleration(acceleration);
             }
 
             status encoder::encode_frame(file_types::frame_info &info, const uint8_t *input, uint8_t * output, uint32_t &output_size)
             {
                 LOG_FUNC_SCOPE();
                 auto codec = m_codecs.at(info.stream);
-                return codec ? m_codecs[info.stream]->encode(info, input, output, output_size) : status::status_feature_unsupported;
+                if(!codec) return status::status_feature_unsupported;
+                auto encode_start = std::chrono::steady_clock::now();
+                auto sts = codec->encode(info, input, output, output_size);
+                std::chrono::duration<double, std::micro> encode_time = std::chrono::steady_clock::now() - encode_start;
+                size_t bucket = 0;
+                if(encode_time.count() > 1)
+                    bucket = static_cast<size_t>(std::ceil(std::log(encode_time.count()) / std::log(ENCODE_TIME_GROWTH)));
+                (*m_encode_times.at(info.stream))[bucket < ENCODE_TIME_BUCKETS_COUNT ? bucket : ENCODE_TIME_BUCKETS_COUNT - 1]++;
+                return sts;
+            }
+
+            double encoder::get_encode_time_percentile(rs_stream stream, double percentile)
+            {
+                auto encode_times = m_encode_times.find(stream);
+                if(encode_times == m_encode_times.end()) return 0;
+                std::array<uint64_t, ENCODE_TIME_BUCKETS_COUNT> buckets;
+                uint64_t frames_count = 0;
+                for(size_t i = 0; i < ENCODE_TIME_BUCKETS_COUNT; i++)
+                {
+                    buckets[i] = (*encode_times->second)[i];
+                    frames_count += buckets[i];
+                }
+                if(frames_count == 0) return 0;
+                auto rank = static_cast<uint64_t>(std::ceil(percentile * static_cast<double>(frames_count)));
+                uint64_t accumulated = 0;
+                size_t bucket = 0;
+                for(; bucket < ENCODE_TIME_BUCKETS_COUNT - 1; bucket++)
+                {
+                    accumulated += buckets[bucket];
+                    if(accumulated >= rank) break;
+                }
+                return std::pow(ENCODE_TIME_GROWTH, static_cast<double>(bucket)) / 1000;
             }
         }
     }
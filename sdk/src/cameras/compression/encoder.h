@@ -3,6 +3,9 @@
 
 #pragma once
 #include <map>
+#include <vector>
+#include <array>
+#include <atomic>
 #include <memory>
 #include <tuple>
 #include <librealsense/rs.hpp>
@@ -21,13 +24,34 @@ namespace rs
                 encoder();
                 ~encoder();
 
+                //called concurrently by the record encoder threads, codecs are added before streaming starts
                 status encode_frame(file_types::frame_info &info, const uint8_t * input, uint8_t * output, uint32_t &output_size);
                 file_types::compression_type get_compression_type(rs_stream stream);
-                void add_codec(rs_stream stream, rs_format format, record::compression_level compression_level);
+                //the output buffer size required to encode a frame, compressed data may exceed the raw data size
+                uint32_t get_max_encoded_size(const file_types::frame_info &info);
+                //lossy compression applies to the formats supported by the jpeg codec, other formats are compressed losslessly
+                //stripes_count > 1 splits lossless frames, other than depth, to row stripes, which are decoded concurrently on playback
+                void add_codec(rs_stream stream, rs_format format, record::compression_level compression_level, bool is_lossy = false, uint32_t stripes_count = 1);
+                //the codecs added with adaptive compression level
+                bool is_adaptive() { return !m_adaptive_codecs.empty(); }
+                //the stream codec was added with adaptive compression level
+                bool is_adaptive(rs_stream stream);
+                void set_acceleration(int acceleration);
+                //the acceleration of the low compression level, the fastest adaptive compression
+                static int get_max_acceleration();
+                //the encode time in milliseconds below which the requested share of the stream frames were encoded, 0 if no frame was encoded
+                double get_encode_time_percentile(rs_stream stream, double percentile);
 
             private:
-                file_types::compression_type compression_policy(rs_stream stream, rs_format format);
+                //bucket i counts the frames encoded in up to ENCODE_TIME_GROWTH^i microseconds
+                static const size_t ENCODE_TIME_BUCKETS_COUNT = 80;
+                typedef std::array<std::atomic<uint64_t>, ENCODE_TIME_BUCKETS_COUNT> encode_time_histogram;
+                static const double ENCODE_TIME_GROWTH;
+                
+                file_types::compression_type compression_policy(rs_stream stream, rs_format format, bool is_lossy, uint32_t stripes_count);
                 std::map<rs_stream,std::shared_ptr<codec_interface>> m_codecs;
+                std::vector<std::shared_ptr<codec_interface>> m_adaptive_codecs;
+                std::map<rs_stream,std::unique_ptr<encode_time_histogram>> m_encode_times;
             };
         }
     }
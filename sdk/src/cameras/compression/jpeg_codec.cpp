@@ -0,0 +1,149 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2016 Intel Corporation. All Rights Reserved.
+
+#include <vector>
+#include <string.h>
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+#include <opencv2/imgcodecs/imgcodecs.hpp>
+#include "jpeg_codec.h"
+#include "rs/utils/log_utils.h"
+
+namespace
+{
+    struct jpeg_format
+    {
+        int type;           //the opencv type of the frame
+        int to_bgr;         //conversion from the frame format to the jpeg input format, -1 if not required
+        int from_bgr;       //conversion from the jpeg output format to the frame format, -1 if not required
+        int imread_flags;
+    };
+
+    bool get_jpeg_format(rs_format format, jpeg_format & jformat)
+    {
+        switch(format)
+        {
+            case rs_format::RS_FORMAT_RGB8: jformat = {CV_8UC3, cv::COLOR_RGB2BGR, cv::COLOR_BGR2RGB, cv::IMREAD_COLOR}; return true;
+            case rs_format::RS_FORMAT_BGR8: jformat = {CV_8UC3, -1, -1, cv::IMREAD_COLOR}; return true;
+            //jpeg doesn't keep an alpha channel, formats with alpha are compressed losslessly
+            default: return false;
+        }
+    }
+}
+
+namespace rs
+{
+    namespace core
+    {
+        namespace compression
+        {
+            jpeg_codec::jpeg_codec() : m_quality(0)
+            {
+
+            }
+
+            jpeg_codec::jpeg_codec(record::compression_level compression_level) : m_quality(0)
+            {
+                switch (compression_level)
+                {
+                    case record::compression_level::low: m_quality = 95; break;
+                    case record::compression_level::medium:
+                    case record::compression_level::adaptive: m_quality = 85; break;
+                    case record::compression_level::high: m_quality = 75; break;
+                    default: m_quality = 75; break;
+                }
+            }
+
+            jpeg_codec::~jpeg_codec(void)
+            {
+                LOG_FUNC_SCOPE();
+            }
+
+            bool jpeg_codec::is_format_supported(rs_format format)
+            {
+                jpeg_format jformat;
+                return get_jpeg_format(format, jformat);
+            }
+
+            status jpeg_codec::encode(file_types::frame_info &info, const uint8_t * input, uint8_t * output, uint32_t &output_size)
+            {
+                LOG_FUNC_SCOPE();
+
+                if (!input)
+                {
+                    LOG_ERROR("input data is null");
+                    return status::status_process_failed;
+                }
+                jpeg_format jformat;
+                if(!get_jpeg_format(info.format, jformat))
+                {
+                    LOG_ERROR("unsupported jpeg format - " << info.format);
+                    return status::status_param_unsupported;
+                }
+
+                cv::Mat image(info.height, info.width, jformat.type, const_cast<uint8_t*>(input), static_cast<size_t>(info.stride));
+                cv::Mat bgr;
+                if(jformat.to_bgr >= 0)
+                    cv::cvtColor(image, bgr, jformat.to_bgr);
+                else
+                    bgr = image;
+
+                std::vector<uchar> buffer;
+                std::vector<int> params = {cv::IMWRITE_JPEG_QUALITY, m_quality};
+                if(!cv::imencode(".jpg", bgr, buffer, params))
+                {
+                    LOG_ERROR("failed to encode jpeg frame");
+                    return status::status_process_failed;
+                }
+
+                //jpeg may exceed the raw size on small noisy frames, the raw frame is stored instead and identified by its size on decode
+                uint32_t raw_size = static_cast<uint32_t>(info.stride * info.height);
+                if(buffer.size() >= raw_size)
+                {
+                    memcpy(output, input, raw_size);
+                    output_size = raw_size;
+                    return status::status_no_error;
+                }
+                memcpy(output, buffer.data(), buffer.size());
+                output_size = static_cast<uint32_t>(buffer.size());
+                return status::status_no_error;
+            }
+
+            std::shared_ptr<file_types::frame_sample> jpeg_codec::decode(std::shared_ptr<file_types::frame_sample> frame, const uint8_t * input, uint32_t input_size)
+            {
+                LOG_FUNC_SCOPE();
+
+                jpeg_format jformat;
+                if(!get_jpeg_format(frame->finfo.format, jformat))
+                {
+                    LOG_ERROR("unsupported jpeg format - " << frame->finfo.format);
+                    return nullptr;
+                }
+
+                uint32_t raw_size = static_cast<uint32_t>(frame->finfo.stride * frame->finfo.height);
+                uint8_t * data = nullptr;
+                auto rv = create_decoded_frame(frame, raw_size, data);
+                if(input_size == raw_size)
+                {
+                    memcpy(data, input, raw_size);
+                    return rv;
+                }
+
+                //the input header is not modified by imdecode, the input may be a read only file mapping
+                cv::Mat bgr = cv::imdecode(cv::Mat(1, static_cast<int>(input_size), CV_8UC1, const_cast<uint8_t*>(input)), jformat.imread_flags);
+                if(bgr.empty() || bgr.cols != frame->finfo.width || bgr.rows != frame->finfo.height)
+                {
+                    LOG_ERROR("failed to decode jpeg frame");
+                    return nullptr;
+                }
+
+                cv::Mat image(frame->finfo.height, frame->finfo.width, jformat.type, data, static_cast<size_t>(frame->finfo.stride));
+                if(jformat.from_bgr >= 0)
+                    cv::cvtColor(bgr, image, jformat.from_bgr);
+                else
+                    bgr.copyTo(image);
+                return rv;
+            }
+        }
+    }
+}
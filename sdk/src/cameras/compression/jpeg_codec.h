@@ -0,0 +1,37 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2016 Intel Corporation. All Rights Reserved.
+
+#pragma once
+#include "codec_interface.h"
+#include "rs/record/record_device.h"
+
+namespace rs
+{
+    namespace core
+    {
+        namespace compression
+        {
+            /**
+            * @class jpeg_codec
+            * @brief Lossy intra frame color codec.
+            *
+            * Each RGB8 or BGR8 frame is encoded separately as JPEG, the quality is set by the compression level.
+            * The codec is stateless, frames of the same stream can be encoded and decoded concurrently.
+            */
+            class jpeg_codec : public codec_interface
+            {
+            public:
+                jpeg_codec();
+                jpeg_codec(record::compression_level compression_level);
+                virtual ~jpeg_codec();
+
+                virtual status encode(file_types::frame_info &info, const uint8_t * input, uint8_t * output, uint32_t &output_size) override;
+                virtual std::shared_ptr<file_types::frame_sample> decode(std::shared_ptr<file_types::frame_sample> frame, const uint8_t * input, uint32_t input_size) override;
+                virtual file_types::compression_type get_compression_type() override { return file_types::compression_type::jpeg; }
+                static bool is_format_supported(rs_format format);
+            private:
+                int m_quality;
+            };
+        }
+    }
+}
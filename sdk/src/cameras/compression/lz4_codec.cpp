@@ -18,14 +18,21 @@ namespace rs
 
             }
 
-            lz4_codec::lz4_codec(record::compression_level compression_level) : m_compression_level(0)
+            lz4_codec::lz4_codec(record::compression_level compression_level) :
+                m_compression_level(get_acceleration(compression_level))
+            {
+
+            }
+
+            int lz4_codec::get_acceleration(record::compression_level compression_level)
             {
                 switch (compression_level)
                 {
-                    case record::compression_level::low: m_compression_level = 100; break;
-                    case record::compression_level::medium:  m_compression_level = 17; break;
-                    case record::compression_level::high: m_compression_level = 0; break;
-                    default: m_compression_level = 0; break;
+                    case record::compression_level::low: return 100;
+                    case record::compression_level::medium: return 17;
+                    case record::compression_level::high: return 0;
+                    case record::compression_level::adaptive: return 1;//starts at the best ratio, raised while recording under pressure
+                    default: return 0;
                 }
             }
 
@@ -34,17 +41,17 @@ namespace rs
                 LOG_FUNC_SCOPE();
             }
 
-            std::shared_ptr<file_types::frame_sample> lz4_codec::decode(std::shared_ptr<file_types::frame_sample> frame, uint8_t * input, uint32_t input_size)
+            std::shared_ptr<file_types::frame_sample> lz4_codec::decode(std::shared_ptr<file_types::frame_sample> frame, const uint8_t * input, uint32_t input_size)
             {
                 LOG_FUNC_SCOPE();
 
-                auto rv = std::shared_ptr<file_types::frame_sample>(
-                new file_types::frame_sample(frame.get()), [](file_types::frame_sample* f){delete[] f->data; delete f;});
-
                 int frame_size = frame->finfo.stride * frame->finfo.height;
-                auto data = new uint8_t[frame_size];
-                auto read = LZ4_decompress_fast (reinterpret_cast<char*>(input), reinterpret_cast<char*>(data), frame_size);
-                rv->data = data;
+                uint8_t * data = nullptr;
+                auto rv = create_decoded_frame(frame, static_cast<size_t>(frame_size), data);
+                //the input size is bounded, the input may be a file mapping which can't be read beyond its end
+                auto read = LZ4_decompress_safe(reinterpret_cast<const char*>(input), reinterpret_cast<char*>(data), static_cast<int>(input_size), frame_size);
+                if(read != frame_size)
+                    LOG_ERROR("failed to decompress lz4 frame");
                 return rv;
             }
 
@@ -59,7 +66,7 @@ namespace rs
                 }
 
                 int input_size = info.stride * info.height;
-                output_size = LZ4_compress_fast(reinterpret_cast<const char*>(input), reinterpret_cast<char*>(output), input_size, input_size, m_compression_level);
+                output_size = LZ4_compress_fast(reinterpret_cast<const char*>(input), reinterpret_cast<char*>(output), input_size, LZ4_compressBound(input_size), m_compression_level);
                 return status::status_no_error;
             }
         }
@@ -2,6 +2,7 @@
 // Copyright(c) 2016 Intel Corporation. All Rights Reserved.
 
 #pragma once
+#include <atomic>
 #include <thread>
 #include <map>
 #include "codec_interface.h"
@@ -21,10 +22,12 @@ namespace rs
                 virtual ~lz4_codec();
 
                 virtual status encode(file_types::frame_info &info, const uint8_t * input, uint8_t * output, uint32_t &output_size) override;
-                virtual std::shared_ptr<file_types::frame_sample> decode(std::shared_ptr<file_types::frame_sample> frame, uint8_t * input, uint32_t input_size) override;
+                virtual std::shared_ptr<file_types::frame_sample> decode(std::shared_ptr<file_types::frame_sample> frame, const uint8_t * input, uint32_t input_size) override;
+                virtual void set_acceleration(int acceleration) override { m_compression_level = acceleration; }
                 virtual file_types::compression_type get_compression_type() override { return file_types::compression_type::lz4; }
+                static int get_acceleration(record::compression_level compression_level);
             private:
-                uint32_t m_compression_level;
+                std::atomic<int> m_compression_level;
             };
         }
     }
@@ -0,0 +1,166 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2016 Intel Corporation. All Rights Reserved.
+
+#include <vector>
+#include <future>
+#include <thread>
+#include <string.h>
+#include "striped_lz4_codec.h"
+#include "lz4_codec.h"
+#include "rs/utils/log_utils.h"
+#include "lz4.h"
+
+namespace
+{
+    const uint32_t LZ4_BLOCK_OVERHEAD = 16; //LZ4_compressBound constant overhead per block
+}
+
+namespace rs
+{
+    namespace core
+    {
+        namespace compression
+        {
+            striped_lz4_codec::striped_lz4_codec() : m_compression_level(0), m_stripes_count(1)
+            {
+
+            }
+
+            striped_lz4_codec::striped_lz4_codec(record::compression_level compression_level, uint32_t stripes_count) :
+                m_compression_level(lz4_codec::get_acceleration(compression_level)),
+                m_stripes_count(stripes_count == 0 ? 1 : stripes_count > MAX_STRIPES_COUNT ? MAX_STRIPES_COUNT : stripes_count)
+            {
+
+            }
+
+            striped_lz4_codec::~striped_lz4_codec(void)
+            {
+                LOG_FUNC_SCOPE();
+            }
+
+            uint32_t striped_lz4_codec::get_max_overhead()
+            {
+                return 2 * static_cast<uint32_t>(sizeof(uint32_t)) + MAX_STRIPES_COUNT * (static_cast<uint32_t>(sizeof(uint32_t)) + LZ4_BLOCK_OVERHEAD);
+            }
+
+            status striped_lz4_codec::encode(file_types::frame_info &info, const uint8_t * input, uint8_t * output, uint32_t &output_size)
+            {
+                LOG_FUNC_SCOPE();
+
+                if (!input || info.height <= 0)
+                {
+                    LOG_ERROR("input data is null");
+                    return status::status_process_failed;
+                }
+
+                uint32_t height = static_cast<uint32_t>(info.height);
+                uint32_t stride = static_cast<uint32_t>(info.stride);
+                uint32_t stripes_count = m_stripes_count < height ? m_stripes_count : height;
+                uint32_t stripe_rows = (height + stripes_count - 1) / stripes_count;
+                stripes_count = (height + stripe_rows - 1) / stripe_rows;
+
+                //frames of a stream are encoded concurrently by the record encoder threads, stripes are encoded sequentially
+                auto stripe_table = reinterpret_cast<uint32_t*>(output);
+                stripe_table[0] = stripes_count;
+                stripe_table[1] = stripe_rows;
+                uint8_t * data = output + (stripes_count + 2) * sizeof(uint32_t);
+                for(uint32_t i = 0; i < stripes_count; i++)
+                {
+                    uint32_t first_row = i * stripe_rows;
+                    uint32_t rows = first_row + stripe_rows < height ? stripe_rows : height - first_row;
+                    int stripe_size = static_cast<int>(rows * stride);
+                    int compressed_size = LZ4_compress_fast(reinterpret_cast<const char*>(input + first_row * stride), reinterpret_cast<char*>(data),
+                                                            stripe_size, LZ4_compressBound(stripe_size), m_compression_level);
+                    if(compressed_size <= 0)
+                    {
+                        LOG_ERROR("failed to compress frame stripe");
+                        return status::status_process_failed;
+                    }
+                    stripe_table[i + 2] = static_cast<uint32_t>(compressed_size);
+                    data += compressed_size;
+                }
+                output_size = static_cast<uint32_t>(data - output);
+                return status::status_no_error;
+            }
+
+            std::shared_ptr<file_types::frame_sample> striped_lz4_codec::decode(std::shared_ptr<file_types::frame_sample> frame, const uint8_t * input, uint32_t input_size)
+            {
+                LOG_FUNC_SCOPE();
+
+                uint32_t height = static_cast<uint32_t>(frame->finfo.height);
+                uint32_t stride = static_cast<uint32_t>(frame->finfo.stride);
+                uint32_t stripes_count = 0;
+                uint32_t stripe_rows = 0;
+                if(input_size >= 2 * sizeof(uint32_t))
+                {
+                    memcpy(&stripes_count, input, sizeof(uint32_t));
+                    memcpy(&stripe_rows, input + sizeof(uint32_t), sizeof(uint32_t));
+                }
+                uint32_t table_size = (stripes_count + 2) * static_cast<uint32_t>(sizeof(uint32_t));
+                if(stripes_count == 0 || stripes_count > MAX_STRIPES_COUNT || static_cast<uint64_t>(stripes_count) * stripe_rows < height ||
+                   (stripes_count - 1) * stripe_rows >= height || input_size < table_size)
+                {
+                    LOG_ERROR("invalid stripe table");
+                    return nullptr;
+                }
+
+                std::vector<uint32_t> stripe_sizes(stripes_count);
+                memcpy(stripe_sizes.data(), input + 2 * sizeof(uint32_t), stripes_count * sizeof(uint32_t));
+                std::vector<uint32_t> stripe_offsets(stripes_count);
+                uint64_t offset = table_size;
+                for(uint32_t i = 0; i < stripes_count; i++)
+                {
+                    stripe_offsets[i] = static_cast<uint32_t>(offset);
+                    offset += stripe_sizes[i];
+                }
+                if(offset > input_size)
+                {
+                    LOG_ERROR("invalid stripe table");
+                    return nullptr;
+                }
+
+                uint8_t * data = nullptr;
+                auto rv = create_decoded_frame(frame, stride * height, data);
+
+                //the stripes are referenced by the pool tasks, all of them are waited for before returning
+                auto decode_stripe = [&](uint32_t i) -> bool
+                {
+                    uint32_t first_row = i * stripe_rows;
+                    uint32_t rows = first_row + stripe_rows < height ? stripe_rows : height - first_row;
+                    int stripe_size = static_cast<int>(rows * stride);
+                    return LZ4_decompress_safe(reinterpret_cast<const char*>(input + stripe_offsets[i]), reinterpret_cast<char*>(data + first_row * stride),
+                                               static_cast<int>(stripe_sizes[i]), stripe_size) == stripe_size;
+                };
+
+                //the first stripe is decoded on the calling thread while the rest are decoded concurrently
+                std::vector<std::future<bool>> stripes;
+                if(stripes_count > 1)
+                {
+                    auto & decode_pool = get_decode_pool();
+                    for(uint32_t i = 1; i < stripes_count; i++)
+                        stripes.push_back(decode_pool.submit<bool>([&decode_stripe, i]() { return decode_stripe(i); }));
+                }
+                bool is_valid = decode_stripe(0);
+                for(auto & stripe : stripes)
+                    is_valid = stripe.get() && is_valid;
+                if(!is_valid)
+                {
+                    LOG_ERROR("failed to decompress frame stripes");
+                    return nullptr;
+                }
+                return rv;
+            }
+
+            thread_pool & striped_lz4_codec::get_decode_pool()
+            {
+                std::call_once(m_decode_pool_flag, [this]()
+                {
+                    //the calling thread decodes a stripe as well
+                    uint32_t threads_count = std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 1;
+                    m_decode_pool.reset(new thread_pool(threads_count));
+                });
+                return *m_decode_pool;
+            }
+        }
+    }
+}
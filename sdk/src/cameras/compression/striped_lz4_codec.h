@@ -0,0 +1,51 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2016 Intel Corporation. All Rights Reserved.
+
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include "codec_interface.h"
+#include "include/thread_pool.h"
+#include "rs/record/record_device.h"
+
+namespace rs
+{
+    namespace core
+    {
+        namespace compression
+        {
+            /**
+            * @class striped_lz4_codec
+            * @brief Lossless codec, compresses each frame as independent lz4 blocks of rows.
+            *
+            * The encoded frame starts with a stripe table: the number of stripes and the rows per stripe, followed by the compressed size of each stripe.
+            * Stripes are decoded concurrently by a pool of threads owned by the codec, which reduces the decode latency of large frames.
+            */
+            class striped_lz4_codec : public codec_interface
+            {
+            public:
+                static const uint32_t MAX_STRIPES_COUNT = 64;
+
+                striped_lz4_codec();
+                striped_lz4_codec(record::compression_level compression_level, uint32_t stripes_count);
+                virtual ~striped_lz4_codec();
+
+                virtual status encode(file_types::frame_info &info, const uint8_t * input, uint8_t * output, uint32_t &output_size) override;
+                virtual std::shared_ptr<file_types::frame_sample> decode(std::shared_ptr<file_types::frame_sample> frame, const uint8_t * input, uint32_t input_size) override;
+                virtual void set_acceleration(int acceleration) override { m_compression_level = acceleration; }
+                virtual file_types::compression_type get_compression_type() override { return file_types::compression_type::lz4_striped; }
+                //the encoded size overhead of the stripe table and of the per stripe lz4 bound
+                static uint32_t get_max_overhead();
+            private:
+                //the pool is created on the first decode, the codec is used either to encode or to decode
+                core::thread_pool & get_decode_pool();
+
+                std::atomic<int>                    m_compression_level;
+                uint32_t                            m_stripes_count;
+                std::once_flag                      m_decode_pool_flag;
+                std::unique_ptr<core::thread_pool>  m_decode_pool;
+            };
+        }
+    }
+}
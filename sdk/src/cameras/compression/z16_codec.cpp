@@ -0,0 +1,170 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2016 Intel Corporation. All Rights Reserved.
+
+#include <thread>
+#include <algorithm>
+#include "z16_codec.h"
+#include "lz4_codec.h"
+#include "rs/utils/log_utils.h"
+#include "lz4.h"
+
+namespace
+{
+    inline uint16_t predict(uint16_t left, uint16_t up, uint16_t up_left)
+    {
+        //written with conditional moves only, the noisy depth data makes branches unpredictable
+        uint16_t min = left < up ? left : up;
+        uint16_t max = left < up ? up : left;
+        uint16_t gradient = static_cast<uint16_t>(left + up - up_left);
+        uint16_t rv = up_left >= max ? min : gradient;
+        return up_left <= min ? max : rv;
+    }
+
+    inline uint16_t zigzag_encode(uint16_t residual)
+    {
+        return static_cast<uint16_t>((residual << 1) ^ (0 - (residual >> 15)));
+    }
+
+    inline uint16_t zigzag_decode(uint16_t value)
+    {
+        return static_cast<uint16_t>((value >> 1) ^ (0 - (value & 1)));
+    }
+
+    //a planes buffer is kept for each thread that may encode or decode concurrently
+    size_t get_max_free_planes()
+    {
+        size_t threads_count = std::thread::hardware_concurrency();
+        if(threads_count < rs::core::buffer_pool::DEFAULT_MAX_FREE_BUFFERS)
+            threads_count = rs::core::buffer_pool::DEFAULT_MAX_FREE_BUFFERS;
+        return threads_count;
+    }
+
+    inline uint16_t get_prediction(const uint16_t * row, const uint16_t * prev_row, uint32_t x)
+    {
+        if(!prev_row) return x > 0 ? row[x - 1] : 0;
+        if(x == 0) return prev_row[0];
+        return predict(row[x - 1], prev_row[x], prev_row[x - 1]);
+    }
+}
+
+namespace rs
+{
+    namespace core
+    {
+        namespace compression
+        {
+            z16_codec::z16_codec() : m_compression_level(0),
+                m_planes_pool(get_max_free_planes())
+            {
+
+            }
+
+            z16_codec::z16_codec(record::compression_level compression_level) :
+                m_compression_level(lz4_codec::get_acceleration(compression_level)),
+                m_planes_pool(get_max_free_planes())
+            {
+
+            }
+
+            z16_codec::~z16_codec(void)
+            {
+                LOG_FUNC_SCOPE();
+            }
+
+            status z16_codec::encode(file_types::frame_info &info, const uint8_t * input, uint8_t * output, uint32_t &output_size)
+            {
+                LOG_FUNC_SCOPE();
+
+                if (!input)
+                {
+                    LOG_ERROR("input data is null");
+                    return status::status_process_failed;
+                }
+                if (info.stride % sizeof(uint16_t) != 0)
+                {
+                    LOG_ERROR("unexpected z16 stride - " << info.stride);
+                    return status::status_param_unsupported;
+                }
+
+                //the residuals of the whole buffer including the stride padding are coded, so decoding restores the exact input
+                uint32_t row_size = static_cast<uint32_t>(info.stride / sizeof(uint16_t));
+                uint32_t height = info.height;
+                uint32_t plane_size = row_size * height;
+                auto planes = m_planes_pool.acquire(plane_size * 2);
+                uint8_t * low = planes.get();
+                uint8_t * high = low + plane_size;
+
+                const uint16_t * prev_row = nullptr;
+                for(uint32_t y = 0; y < height; y++)
+                {
+                    const uint16_t * row = reinterpret_cast<const uint16_t*>(input + y * info.stride);
+                    uint8_t * low_row = low + y * row_size;
+                    uint8_t * high_row = high + y * row_size;
+                    for(uint32_t x = 0; x < row_size && (x == 0 || !prev_row); x++)
+                    {
+                        uint16_t residual = zigzag_encode(static_cast<uint16_t>(row[x] - get_prediction(row, prev_row, x)));
+                        low_row[x] = static_cast<uint8_t>(residual);
+                        high_row[x] = static_cast<uint8_t>(residual >> 8);
+                    }
+                    if(prev_row)
+                    {
+                        for(uint32_t x = 1; x < row_size; x++)
+                        {
+                            uint16_t residual = zigzag_encode(static_cast<uint16_t>(row[x] - predict(row[x - 1], prev_row[x], prev_row[x - 1])));
+                            low_row[x] = static_cast<uint8_t>(residual);
+                            high_row[x] = static_cast<uint8_t>(residual >> 8);
+                        }
+                    }
+                    prev_row = row;
+                }
+
+                int input_size = static_cast<int>(plane_size * 2);
+                auto compressed_size = LZ4_compress_fast(reinterpret_cast<const char*>(planes.get()), reinterpret_cast<char*>(output),
+                                                         input_size, LZ4_compressBound(input_size), m_compression_level);
+                if(compressed_size <= 0)
+                {
+                    LOG_ERROR("failed to compress depth frame");
+                    return status::status_process_failed;
+                }
+                output_size = static_cast<uint32_t>(compressed_size);
+                return status::status_no_error;
+            }
+
+            std::shared_ptr<file_types::frame_sample> z16_codec::decode(std::shared_ptr<file_types::frame_sample> frame, const uint8_t * input, uint32_t input_size)
+            {
+                LOG_FUNC_SCOPE();
+
+                uint32_t stride = frame->finfo.stride;
+                uint32_t row_size = static_cast<uint32_t>(stride / sizeof(uint16_t));
+                uint32_t height = frame->finfo.height;
+                uint32_t plane_size = row_size * height;
+                int planes_size = static_cast<int>(plane_size * 2);
+                auto planes = m_planes_pool.acquire(plane_size * 2);
+                auto read = LZ4_decompress_safe(reinterpret_cast<const char*>(input), reinterpret_cast<char*>(planes.get()),
+                                                static_cast<int>(input_size), planes_size);
+                if(read != planes_size)
+                {
+                    LOG_ERROR("failed to decompress depth frame");
+                    return nullptr;
+                }
+                const uint8_t * low = planes.get();
+                const uint8_t * high = low + plane_size;
+
+                uint8_t * data = nullptr;
+                auto rv = create_decoded_frame(frame, stride * height, data);
+                const uint16_t * prev_row = nullptr;
+                for(uint32_t y = 0; y < height; y++)
+                {
+                    uint16_t * row = reinterpret_cast<uint16_t*>(data + y * stride);
+                    for(uint32_t x = 0; x < row_size; x++)
+                    {
+                        uint16_t residual = static_cast<uint16_t>(low[y * row_size + x] | (high[y * row_size + x] << 8));
+                        row[x] = static_cast<uint16_t>(zigzag_decode(residual) + get_prediction(row, prev_row, x));
+                    }
+                    prev_row = row;
+                }
+                return rv;
+            }
+        }
+    }
+}
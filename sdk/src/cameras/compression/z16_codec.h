@@ -0,0 +1,40 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2016 Intel Corporation. All Rights Reserved.
+
+#pragma once
+#include <atomic>
+#include "codec_interface.h"
+#include "rs/record/record_device.h"
+
+namespace rs
+{
+    namespace core
+    {
+        namespace compression
+        {
+            /**
+            * @class z16_codec
+            * @brief Lossless depth codec.
+            *
+            * Each pixel is predicted from its left, upper and upper left neighbours (LOCO-I median predictor),
+            * the zigzag coded residuals are split to low and high byte planes and the planes are compressed with LZ4.
+            * Neighbouring depth pixels differ by small values, so the high byte plane is mostly zeros and compresses well.
+            */
+            class z16_codec : public codec_interface
+            {
+            public:
+                z16_codec();
+                z16_codec(record::compression_level compression_level);
+                virtual ~z16_codec();
+
+                virtual status encode(file_types::frame_info &info, const uint8_t * input, uint8_t * output, uint32_t &output_size) override;
+                virtual std::shared_ptr<file_types::frame_sample> decode(std::shared_ptr<file_types::frame_sample> frame, const uint8_t * input, uint32_t input_size) override;
+                virtual void set_acceleration(int acceleration) override { m_compression_level = acceleration; }
+                virtual file_types::compression_type get_compression_type() override { return file_types::compression_type::z16_lz4; }
+            private:
+                std::atomic<int> m_compression_level;
+                core::buffer_pool m_planes_pool; //byte planes scratch buffers, frames are encoded and decoded concurrently
+            };
+        }
+    }
+}
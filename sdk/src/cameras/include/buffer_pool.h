@@ -0,0 +1,110 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2016 Intel Corporation. All Rights Reserved.
+
+#pragma once
+#include <map>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+
+namespace rs
+{
+    namespace core
+    {
+        /**
+        * @class buffer_pool
+        * @brief Thread safe cache of raw byte buffers.
+        *
+        * A buffer acquired from the pool is returned to the pool when its last reference is released,
+        * so frames of a constant size are served without heap allocation after the first few frames.
+        * Up to max free buffers are kept per size, buffers released beyond that are deleted, so a burst doesn't hold its peak memory.
+        * Buffers may outlive the pool, in that case they are deleted on release.
+        */
+        class buffer_pool
+        {
+            struct pool_state
+            {
+                explicit pool_state(size_t max_free_buffers) : max_free_buffers(max_free_buffers) {}
+                std::mutex                                  mutex;
+                std::map<size_t, std::vector<uint8_t*>>     free_buffers;
+                size_t                                      max_free_buffers; //per buffer size
+                ~pool_state()
+                {
+                    for(auto & buffers : free_buffers)
+                        for(auto buffer : buffers.second)
+                            delete[] buffer;
+                }
+            };
+
+        public:
+            static const size_t DEFAULT_MAX_FREE_BUFFERS = 4;
+
+            explicit buffer_pool(size_t max_free_buffers = DEFAULT_MAX_FREE_BUFFERS) : m_state(std::make_shared<pool_state>(max_free_buffers)) {}
+
+            //the free buffers beyond the new limit are deleted
+            void set_max_free_buffers(size_t max_free_buffers)
+            {
+                std::lock_guard<std::mutex> guard(m_state->mutex);
+                m_state->max_free_buffers = max_free_buffers;
+                for(auto & buffers : m_state->free_buffers)
+                {
+                    while(buffers.second.size() > max_free_buffers)
+                    {
+                        delete[] buffers.second.back();
+                        buffers.second.pop_back();
+                    }
+                }
+            }
+
+            std::shared_ptr<uint8_t> acquire(size_t size)
+            {
+                uint8_t * buffer = nullptr;
+                {
+                    std::lock_guard<std::mutex> guard(m_state->mutex);
+                    auto & buffers = m_state->free_buffers[size];
+                    if(!buffers.empty())
+                    {
+                        buffer = buffers.back();
+                        buffers.pop_back();
+                    }
+                }
+                if(!buffer)
+                    buffer = new uint8_t[size];
+
+                std::weak_ptr<pool_state> state = m_state;
+                return std::shared_ptr<uint8_t>(buffer, [state, size](uint8_t * buffer)
+                {
+                    auto pool = state.lock();
+                    if(!pool)
+                    {
+                        delete[] buffer;
+                        return;
+                    }
+                    {
+                        std::lock_guard<std::mutex> guard(pool->mutex);
+                        auto & buffers = pool->free_buffers[size];
+                        if(buffers.size() < pool->max_free_buffers)
+                        {
+                            buffers.push_back(buffer);
+                            return;
+                        }
+                    }
+                    delete[] buffer;
+                });
+            }
+
+            void clear()
+            {
+                std::lock_guard<std::mutex> guard(m_state->mutex);
+                for(auto & buffers : m_state->free_buffers)
+                    for(auto buffer : buffers.second)
+                        delete[] buffer;
+                m_state->free_buffers.clear();
+            }
+
+        private:
+            std::shared_ptr<pool_state> m_state;
+        };
+    }
+}
@@ -0,0 +1,284 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2016 Intel Corporation. All Rights Reserved.
+
+#pragma once
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include "file.h"
+
+namespace rs
+{
+    namespace core
+    {
+        /**
+        * @class buffered_file
+        * @brief Linux write only file, stages the written bytes in a large aligned buffer.
+        *
+        * The buffer is flushed with pwrite, large writes are flushed together with the staged bytes with pwritev.
+        * Writes to positions that were already flushed, as done for header updates, are written directly to the file.
+        * The file space can be preallocated with fallocate, and the page cache can be bypassed with O_DIRECT.
+        * Space preallocated beyond the end of the file is released when the file is closed.
+        */
+        class buffered_file : public file
+        {
+        public:
+            static const size_t DEFAULT_BUFFER_SIZE = 8 << 20;
+            static const size_t DIRECT_IO_ALIGNMENT = 4096;
+
+            buffered_file(size_t buffer_size = DEFAULT_BUFFER_SIZE, bool direct_io = false, uint64_t preallocation_size = 0) :
+                m_fd(-1),
+                m_buffer(nullptr),
+                m_buffer_size(buffer_size > DIRECT_IO_ALIGNMENT ? buffer_size / DIRECT_IO_ALIGNMENT * DIRECT_IO_ALIGNMENT : DIRECT_IO_ALIGNMENT),
+                m_buffer_used(0),
+                m_buffer_offset(0),
+                m_position(0),
+                m_end(0),
+                m_allocated(0),
+                m_preallocation_size(preallocation_size),
+                m_direct_io(direct_io) {}
+
+            virtual status open(const std::string& filename, open_file_option mode) override
+            {
+                if(mode != open_file_option::write) return status_feature_unsupported;
+                close();
+
+                void * buffer = nullptr;
+                if(posix_memalign(&buffer, DIRECT_IO_ALIGNMENT, m_buffer_size) != 0) return status_file_open_failed;
+                m_buffer = static_cast<uint8_t*>(buffer);
+
+                int flags = O_WRONLY | O_CREAT | O_TRUNC;
+                m_fd = ::open(filename.c_str(), m_direct_io ? flags | O_DIRECT : flags, 0644);
+                //not all file systems support direct io
+                if(m_fd < 0 && m_direct_io)
+                {
+                    m_direct_io = false;
+                    m_fd = ::open(filename.c_str(), flags, 0644);
+                }
+                if(m_fd < 0)
+                {
+                    free(m_buffer);
+                    m_buffer = nullptr;
+                    return status_file_open_failed;
+                }
+                m_buffer_used = 0;
+                m_buffer_offset = 0;
+                m_position = 0;
+                m_end = 0;
+                m_allocated = 0;
+                return status_no_error;
+            }
+
+            virtual status close() override
+            {
+                if(m_fd < 0) return status_no_error;
+                auto sts = flush(true);
+                //release the preallocated blocks past the last written byte
+                if(m_allocated > m_end && ftruncate(m_fd, static_cast<off_t>(m_end)) != 0 && sts == status_no_error)
+                    sts = status_file_write_failed;
+                if(::close(m_fd) != 0) sts = status_file_close_failed;
+                m_fd = -1;
+                free(m_buffer);
+                m_buffer = nullptr;
+                return sts;
+            }
+
+            virtual status read_bytes(void* data, unsigned int number_of_bytes_to_read, unsigned int& number_of_bytes_read) override
+            {
+                number_of_bytes_read = 0;
+                return status_feature_unsupported;
+            }
+
+            virtual status write_bytes(const void* data, unsigned int number_of_bytes_to_write, unsigned int& number_of_bytes_written) override
+            {
+                number_of_bytes_written = 0;
+                if(m_fd < 0) return status_file_write_failed;
+
+                auto src = static_cast<const uint8_t*>(data);
+                uint64_t size = number_of_bytes_to_write;
+                while(size > 0)
+                {
+                    uint64_t staged_end = m_buffer_offset + m_buffer_used;
+                    uint64_t count = 0;
+                    if(m_position < m_buffer_offset)
+                    {
+                        //update of an already flushed position
+                        count = std::min(size, m_buffer_offset - m_position);
+                        if(write_at(src, count, m_position) != status_no_error) return status_file_write_failed;
+                    }
+                    else if(m_position < staged_end)
+                    {
+                        count = std::min(size, staged_end - m_position);
+                        memcpy(m_buffer + (m_position - m_buffer_offset), src, count);
+                    }
+                    else if(m_position == staged_end)
+                    {
+                        count = size;
+                        if(append(src, count) != status_no_error) return status_file_write_failed;
+                    }
+                    else
+                    {
+                        return status_file_write_failed;//writing beyond the end of file is not supported
+                    }
+                    src += count;
+                    size -= count;
+                    m_position += count;
+                    m_end = std::max(m_end, m_position);
+                }
+                number_of_bytes_written = number_of_bytes_to_write;
+                return status_no_error;
+            }
+
+            virtual status set_position(int64_t distance_to_move, core::move_method method, uint64_t* new_file_pointer = NULL) override
+            {
+                int64_t position = 0;
+                switch(method)
+                {
+                    case move_method::begin: position = distance_to_move; break;
+                    case move_method::current: position = static_cast<int64_t>(m_position) + distance_to_move; break;
+                    case move_method::end: position = static_cast<int64_t>(m_end) + distance_to_move; break;
+                }
+                if(position < 0 || static_cast<uint64_t>(position) > m_end) return status_file_read_failed;
+                m_position = static_cast<uint64_t>(position);
+                if(new_file_pointer != NULL) *new_file_pointer = m_position;
+                return status_no_error;
+            }
+
+            virtual status get_position(uint64_t* new_file_pointer) override
+            {
+                if(new_file_pointer == NULL) return status_file_read_failed;
+                *new_file_pointer = m_position;
+                return m_fd < 0 ? status_file_read_failed : status_no_error;
+            }
+
+            virtual void reset() override
+            {
+                m_position = 0;
+            }
+
+            virtual ~buffered_file()
+            {
+                close();
+            }
+
+        private:
+            status append(const uint8_t * data, uint64_t size)
+            {
+                //large writes are flushed together with the staged bytes, without copying, unless direct io requires aligned memory
+                if(!m_direct_io && size >= m_buffer_size)
+                {
+                    if(preallocate(m_buffer_offset + m_buffer_used + size) != status_no_error) return status_file_write_failed;
+                    struct iovec iov[2] = {{m_buffer, m_buffer_used}, {const_cast<uint8_t*>(data), size}};
+                    int iovcnt = m_buffer_used > 0 ? 2 : 1;
+                    struct iovec * first = m_buffer_used > 0 ? iov : iov + 1;
+                    if(write_vector(first, iovcnt, m_buffer_offset) != status_no_error) return status_file_write_failed;
+                    m_buffer_offset += m_buffer_used + size;
+                    m_buffer_used = 0;
+                    return status_no_error;
+                }
+                while(size > 0)
+                {
+                    uint64_t count = std::min(size, static_cast<uint64_t>(m_buffer_size - m_buffer_used));
+                    memcpy(m_buffer + m_buffer_used, data, count);
+                    m_buffer_used += count;
+                    data += count;
+                    size -= count;
+                    if(m_buffer_used == m_buffer_size && flush(false) != status_no_error) return status_file_write_failed;
+                }
+                return status_no_error;
+            }
+
+            status flush(bool final)
+            {
+                if(m_buffer_used == 0) return status_no_error;
+                uint64_t count = m_buffer_used;
+                //direct io writes must be aligned, the unaligned tail is kept in the buffer until the file is closed
+                if(m_direct_io && !final)
+                    count = m_buffer_used / DIRECT_IO_ALIGNMENT * DIRECT_IO_ALIGNMENT;
+                if(count == 0) return status_no_error;
+                if(preallocate(m_buffer_offset + count) != status_no_error) return status_file_write_failed;
+                auto sts = final ? write_at(m_buffer, count, m_buffer_offset) : write_aligned(m_buffer, count, m_buffer_offset);
+                if(sts != status_no_error) return sts;
+                memmove(m_buffer, m_buffer + count, m_buffer_used - count);
+                m_buffer_offset += count;
+                m_buffer_used -= count;
+                return status_no_error;
+            }
+
+            status preallocate(uint64_t size)
+            {
+                if(m_preallocation_size == 0 || size <= m_allocated) return status_no_error;
+                uint64_t allocated = (size / m_preallocation_size + 1) * m_preallocation_size;
+                //preallocation is an optimization, failure to preallocate doesn't fail the write
+                if(fallocate(m_fd, FALLOC_FL_KEEP_SIZE, static_cast<off_t>(m_allocated), static_cast<off_t>(allocated - m_allocated)) != 0)
+                    m_preallocation_size = 0;
+                m_allocated = allocated;
+                return status_no_error;
+            }
+
+            status write_aligned(const uint8_t * data, uint64_t size, uint64_t offset)
+            {
+                while(size > 0)
+                {
+                    auto written = pwrite(m_fd, data, size, static_cast<off_t>(offset));
+                    if(written <= 0) return status_file_write_failed;
+                    data += written;
+                    size -= static_cast<uint64_t>(written);
+                    offset += static_cast<uint64_t>(written);
+                }
+                return status_no_error;
+            }
+
+            status write_at(const uint8_t * data, uint64_t size, uint64_t offset)
+            {
+                if(!m_direct_io) return write_aligned(data, size, offset);
+                //unaligned writes are done with direct io disabled
+                int flags = fcntl(m_fd, F_GETFL);
+                if(flags < 0 || fcntl(m_fd, F_SETFL, flags & ~O_DIRECT) != 0) return status_file_write_failed;
+                auto sts = write_aligned(data, size, offset);
+                if(fcntl(m_fd, F_SETFL, flags) != 0) return status_file_write_failed;
+                return sts;
+            }
+
+            status write_vector(struct iovec * iov, int iovcnt, uint64_t offset)
+            {
+                while(iovcnt > 0)
+                {
+                    auto written = pwritev(m_fd, iov, iovcnt, static_cast<off_t>(offset));
+                    if(written <= 0) return status_file_write_failed;
+                    offset += static_cast<uint64_t>(written);
+                    //skip the fully written vectors and advance into a partially written one
+                    size_t remaining = static_cast<size_t>(written);
+                    while(iovcnt > 0 && remaining >= iov->iov_len)
+                    {
+                        remaining -= iov->iov_len;
+                        ++iov;
+                        --iovcnt;
+                    }
+                    if(iovcnt > 0)
+                    {
+                        iov->iov_base = static_cast<uint8_t*>(iov->iov_base) + remaining;
+                        iov->iov_len -= remaining;
+                    }
+                }
+                return status_no_error;
+            }
+
+            int         m_fd;
+            uint8_t *   m_buffer;
+            size_t      m_buffer_size;
+            uint64_t    m_buffer_used;
+            uint64_t    m_buffer_offset;    //the file offset of the first staged byte
+            uint64_t    m_position;
+            uint64_t    m_end;
+            uint64_t    m_allocated;
+            uint64_t    m_preallocation_size;
+            bool        m_direct_io;
+        };
+    }
+}
+#endif
@@ -87,7 +87,7 @@ namespace rs
                 m_file.seekp(0, std::ios::beg);
             }
 
-            ~file()
+            virtual ~file()
             {
                 m_file.close();
             }
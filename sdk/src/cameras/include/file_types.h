@@ -38,6 +38,9 @@ namespace rs
                 h264 = 1,
                 lzo = 2,
                 lz4 = 3,
+                z16_lz4 = 4, //lossless depth, delta prediction and byte planes split before lz4
+                jpeg = 5,
+                lz4_striped = 6, //lz4 blocks of rows, preceded by a stripe table
                 compression_type_invalid_value = -1
             };
 
@@ -56,14 +59,16 @@ namespace rs
                 chunk_profile           = 4,
                 chunk_serializeable     = 5,
                 chunk_frame_info        = 6,//frame stream type, frame width, frame height, frame format etc.
-                chunk_sample_data       = 7,//rs_timestamp_data / rs_motion_data / image buffer
+                chunk_sample_data       = 7,//image buffer, or rs_timestamp_data / rs_motion_data of a sample that is not batched
                 chunk_image_metadata    = 8,
-                chunk_frame_indexing    = 9,
+                chunk_frame_indexing    = 9, //samples index, written on record finalization
                 chunk_sw_info           = 10,
                 chunk_sample_info       = 11,//sample type, capture time, offset
                 chunk_capabilities      = 12,
                 chunk_motion_intrinsics = 13,
-                chunk_camera_info       = 14
+                chunk_camera_info       = 14,
+                chunk_frame_count       = 15,//per stream number of frames, written on record finalization
+                chunk_samples_batch     = 16 //motion and time stamp samples, packed as frame indexing records
             };
 
             struct device_cap
@@ -238,6 +243,12 @@ namespace rs
                 stream_profile      profile;
             };
 
+            struct frame_count
+            {
+                rs_stream           stream;
+                int32_t             nframes;
+            };
+
             struct file_header
             {
                 int32_t                         id;                     // File identifier
@@ -291,7 +302,8 @@ namespace rs
                 struct file_header
                 {
                     file_types::file_header data;
-                    int32_t                 reserved[24];
+                    int64_t                 trailer_offset;         // The byte offset of the chunks written on record finalization, 0 if not finalized.
+                    int32_t                 reserved[22];
                 };
 
                 struct motion_intrinsics
@@ -0,0 +1,142 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2016 Intel Corporation. All Rights Reserved.
+
+#pragma once
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <string.h>
+#include <memory>
+#include "file.h"
+
+namespace rs
+{
+    namespace core
+    {
+        /**
+        * @class mapped_file
+        * @brief Linux read only file, the whole file is mapped to memory on open.
+        *
+        * Reads are copied from the mapping, and read_view returns the file bytes in place without a copy.
+        * A view keeps the mapping alive, so it stays valid after the file is closed.
+        */
+        class mapped_file : public file
+        {
+        public:
+            mapped_file() : m_data(nullptr), m_size(0), m_position(0) {}
+
+            virtual status open(const std::string& filename, open_file_option mode) override
+            {
+                if(mode != open_file_option::read) return status_feature_unsupported;
+                close();
+
+                int fd = ::open(filename.c_str(), O_RDONLY);
+                if(fd < 0) return status_file_open_failed;
+                struct stat file_stat = {};
+                if(fstat(fd, &file_stat) != 0)
+                {
+                    ::close(fd);
+                    return status_file_open_failed;
+                }
+                size_t size = static_cast<size_t>(file_stat.st_size);
+                if(size > 0)
+                {
+                    void * data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if(data == MAP_FAILED)
+                    {
+                        ::close(fd);
+                        return status_file_open_failed;
+                    }
+                    m_mapping = std::shared_ptr<uint8_t>(static_cast<uint8_t*>(data), [size](uint8_t * data) { munmap(data, size); });
+                }
+                //the mapping holds its own reference to the file
+                ::close(fd);
+                m_data = m_mapping.get();
+                m_size = size;
+                m_position = 0;
+                return status_no_error;
+            }
+
+            virtual status close() override
+            {
+                m_mapping.reset();
+                m_data = nullptr;
+                m_size = 0;
+                m_position = 0;
+                return status_no_error;
+            }
+
+            virtual status read_bytes(void* data, unsigned int number_of_bytes_to_read, unsigned int& number_of_bytes_read) override
+            {
+                number_of_bytes_read = 0;
+                if(m_position > m_size || m_size - m_position < number_of_bytes_to_read)
+                {
+                    //as a stream read, a failed read moves the position to the end of the file
+                    m_position = m_size;
+                    return status_file_read_failed;
+                }
+                if(number_of_bytes_to_read > 0)
+                    memcpy(data, m_data + m_position, number_of_bytes_to_read);
+                m_position += number_of_bytes_to_read;
+                number_of_bytes_read = number_of_bytes_to_read;
+                return status_no_error;
+            }
+
+            //returns nullptr if the file doesn't hold the requested number of bytes at the current position
+            std::shared_ptr<const uint8_t> read_view(unsigned int number_of_bytes_to_read)
+            {
+                if(m_position > m_size || m_size - m_position < number_of_bytes_to_read) return nullptr;
+                auto view = std::shared_ptr<const uint8_t>(m_mapping, m_data + m_position);
+                m_position += number_of_bytes_to_read;
+                return view;
+            }
+
+            virtual status write_bytes(const void* data, unsigned int number_of_bytes_to_write, unsigned int& number_of_bytes_written) override
+            {
+                number_of_bytes_written = 0;
+                return status_file_write_failed;
+            }
+
+            virtual status set_position(int64_t distance_to_move, core::move_method method, uint64_t* new_file_pointer = NULL) override
+            {
+                int64_t position = distance_to_move;
+                switch(method)
+                {
+                    case move_method::begin: break;
+                    case move_method::current: position += static_cast<int64_t>(m_position); break;
+                    case move_method::end: position += static_cast<int64_t>(m_size); break;
+                }
+                if(position < 0) return status_file_read_failed;
+                m_position = static_cast<uint64_t>(position);
+                if(new_file_pointer != NULL) *new_file_pointer = m_position;
+                return status_no_error;
+            }
+
+            virtual status get_position(uint64_t* new_file_pointer) override
+            {
+                if(new_file_pointer == NULL) return status_file_read_failed;
+                *new_file_pointer = m_position;
+                return status_no_error;
+            }
+
+            virtual void reset() override
+            {
+                m_position = 0;
+            }
+
+            virtual ~mapped_file()
+            {
+                close();
+            }
+
+        private:
+            std::shared_ptr<uint8_t>    m_mapping;
+            const uint8_t *             m_data;
+            uint64_t                    m_size;
+            uint64_t                    m_position;
+        };
+    }
+}
+#endif
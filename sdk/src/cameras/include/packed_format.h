@@ -0,0 +1,230 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2016 Intel Corporation. All Rights Reserved.
+
+#pragma once
+#include <vector>
+#include <memory>
+#include <string.h>
+#include "file_types.h"
+
+namespace rs
+{
+    namespace core
+    {
+        namespace file_types
+        {
+            /**
+            * @brief Per sample headers of file version 4.
+            *
+            * The per sample records are written without the reserved words of the disk_format wrappers.
+            * Integers are written as LEB128 varints, signed values are zigzag coded,
+            * capture time and offset are written as the difference from the previous record of the same sequence.
+            */
+            namespace packed
+            {
+                //the previous record values, each sequence of records (file chunks, trailer index) keeps its own context
+                struct context
+                {
+                    uint64_t capture_time;
+                    uint64_t offset;
+                    long long system_time;
+                };
+
+                class writer
+                {
+                public:
+                    writer(std::vector<uint8_t> & data) : m_data(data) {}
+
+                    void write_varint(uint64_t value)
+                    {
+                        while(value >= 0x80)
+                        {
+                            m_data.push_back(static_cast<uint8_t>(value | 0x80));
+                            value >>= 7;
+                        }
+                        m_data.push_back(static_cast<uint8_t>(value));
+                    }
+
+                    void write_signed(int64_t value)
+                    {
+                        write_varint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+                    }
+
+                    template<typename T> void write_raw(const T & value)
+                    {
+                        auto data = reinterpret_cast<const uint8_t*>(&value);
+                        m_data.insert(m_data.end(), data, data + sizeof(value));
+                    }
+
+                private:
+                    std::vector<uint8_t> & m_data;
+                };
+
+                class reader
+                {
+                public:
+                    reader(const uint8_t * data, size_t size) : m_it(data), m_end(data + size) {}
+
+                    bool read_varint(uint64_t & value)
+                    {
+                        value = 0;
+                        for(uint32_t shift = 0; shift < 64 && m_it < m_end; shift += 7)
+                        {
+                            uint8_t byte = *m_it++;
+                            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                            if((byte & 0x80) == 0) return true;
+                        }
+                        return false;
+                    }
+
+                    bool read_signed(int64_t & value)
+                    {
+                        uint64_t zigzag = 0;
+                        if(!read_varint(zigzag)) return false;
+                        value = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+                        return true;
+                    }
+
+                    template<typename T> bool read_raw(T & value)
+                    {
+                        if(m_it + sizeof(value) > m_end) return false;
+                        memcpy(&value, m_it, sizeof(value));
+                        m_it += sizeof(value);
+                        return true;
+                    }
+
+                    bool is_end() const { return m_it >= m_end; }
+                    const uint8_t * position() const { return m_it; }
+
+                private:
+                    const uint8_t * m_it;
+                    const uint8_t * m_end;
+                };
+
+                inline void write_sample_info(writer & w, const sample_info & info, context & ctx)
+                {
+                    w.write_varint(static_cast<uint64_t>(info.type));
+                    w.write_signed(static_cast<int64_t>(info.capture_time - ctx.capture_time));
+                    w.write_signed(static_cast<int64_t>(info.offset - ctx.offset));
+                    ctx.capture_time = info.capture_time;
+                    ctx.offset = info.offset;
+                }
+
+                //capture time is always written in microseconds
+                inline bool read_sample_info(reader & r, sample_info & info, context & ctx)
+                {
+                    uint64_t type = 0;
+                    int64_t capture_time = 0, offset = 0;
+                    if(!r.read_varint(type) || !r.read_signed(capture_time) || !r.read_signed(offset)) return false;
+                    info.type = static_cast<sample_type>(type);
+                    info.capture_time = ctx.capture_time + static_cast<uint64_t>(capture_time);
+                    info.offset = ctx.offset + static_cast<uint64_t>(offset);
+                    info.capture_time_unit = time_unit::microseconds;
+                    ctx.capture_time = info.capture_time;
+                    ctx.offset = info.offset;
+                    return true;
+                }
+
+                //index in stream is assigned on read and isn't written
+                inline void write_frame_info(writer & w, const frame_info & info, context & ctx)
+                {
+                    w.write_varint(static_cast<uint64_t>(info.stream));
+                    w.write_varint(static_cast<uint64_t>(info.width));
+                    w.write_varint(static_cast<uint64_t>(info.height));
+                    w.write_varint(static_cast<uint64_t>(info.format));
+                    w.write_varint(static_cast<uint64_t>(info.stride));
+                    w.write_varint(static_cast<uint64_t>(info.bpp));
+                    w.write_varint(static_cast<uint64_t>(info.framerate));
+                    w.write_varint(static_cast<uint64_t>(info.time_stamp_domain));
+                    w.write_varint(info.number);
+                    w.write_signed(info.system_time - ctx.system_time);
+                    w.write_raw(info.time_stamp);
+                    ctx.system_time = info.system_time;
+                }
+
+                inline bool read_frame_info(reader & r, frame_info & info, context & ctx)
+                {
+                    uint64_t stream = 0, width = 0, height = 0, format = 0, stride = 0, bpp = 0, framerate = 0, domain = 0, number = 0;
+                    int64_t system_time = 0;
+                    if(!r.read_varint(stream) || !r.read_varint(width) || !r.read_varint(height) || !r.read_varint(format) ||
+                       !r.read_varint(stride) || !r.read_varint(bpp) || !r.read_varint(framerate) || !r.read_varint(domain) ||
+                       !r.read_varint(number) || !r.read_signed(system_time) || !r.read_raw(info.time_stamp))
+                        return false;
+                    info.stream = static_cast<rs_stream>(stream);
+                    info.width = static_cast<int>(width);
+                    info.height = static_cast<int>(height);
+                    info.format = static_cast<rs_format>(format);
+                    info.stride = static_cast<int>(stride);
+                    info.bpp = static_cast<int>(bpp);
+                    info.framerate = static_cast<int>(framerate);
+                    info.time_stamp_domain = static_cast<rs_timestamp_domain>(domain);
+                    info.number = number;
+                    info.system_time = ctx.system_time + system_time;
+                    info.index_in_stream = 0;
+                    ctx.system_time = info.system_time;
+                    return true;
+                }
+
+                //index and samples batch record, the sample info followed by the sample type specific info
+                inline void write_record(writer & w, const std::shared_ptr<sample> & sample, context & ctx)
+                {
+                    switch(sample->info.type)
+                    {
+                        case sample_type::st_image:
+                        {
+                            auto frame = std::dynamic_pointer_cast<frame_sample>(sample);
+                            if(!frame) return;
+                            write_sample_info(w, sample->info, ctx);
+                            write_frame_info(w, frame->finfo, ctx);
+                            break;
+                        }
+                        case sample_type::st_motion:
+                        {
+                            auto motion = std::dynamic_pointer_cast<motion_sample>(sample);
+                            if(!motion) return;
+                            write_sample_info(w, sample->info, ctx);
+                            w.write_raw(motion->data);
+                            break;
+                        }
+                        case sample_type::st_time:
+                        {
+                            auto time = std::dynamic_pointer_cast<time_stamp_sample>(sample);
+                            if(!time) return;
+                            write_sample_info(w, sample->info, ctx);
+                            w.write_raw(time->data);
+                            break;
+                        }
+                    }
+                }
+
+                inline std::shared_ptr<sample> read_record(reader & r, context & ctx)
+                {
+                    sample_info info = {};
+                    if(!read_sample_info(r, info, ctx)) return nullptr;
+                    switch(info.type)
+                    {
+                        case sample_type::st_image:
+                        {
+                            frame_info finfo = {};
+                            if(!read_frame_info(r, finfo, ctx)) return nullptr;
+                            return std::make_shared<frame_sample>(finfo, info);
+                        }
+                        case sample_type::st_motion:
+                        {
+                            rs_motion_data data;
+                            if(!r.read_raw(data)) return nullptr;
+                            return std::make_shared<motion_sample>(data, info);
+                        }
+                        case sample_type::st_time:
+                        {
+                            rs_timestamp_data data;
+                            if(!r.read_raw(data)) return nullptr;
+                            return std::make_shared<time_stamp_sample>(data, info);
+                        }
+                        default: return nullptr;
+                    }
+                }
+            }
+        }
+    }
+}
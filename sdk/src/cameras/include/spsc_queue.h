@@ -0,0 +1,70 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2016 Intel Corporation. All Rights Reserved.
+
+#pragma once
+#include <vector>
+#include <atomic>
+#include <stddef.h>
+
+namespace rs
+{
+    namespace core
+    {
+        /**
+        * @class spsc_queue
+        * @brief Lock free bounded queue of a single producer thread and a single consumer.
+        *
+        * The producer calls try_push only, the consumer calls front and pop only.
+        * The consumer may move between threads if the calls are serialized by the caller, e.g. by a mutex.
+        */
+        template<typename T>
+        class spsc_queue
+        {
+        public:
+            //the capacity is rounded up to a power of two
+            explicit spsc_queue(size_t capacity) : m_head(0), m_tail(0)
+            {
+                size_t size = 2;
+                while(size < capacity) size <<= 1;
+                m_items.resize(size);
+                m_mask = size - 1;
+            }
+
+            bool try_push(T && item)
+            {
+                auto tail = m_tail.load(std::memory_order_relaxed);
+                if(tail - m_head.load(std::memory_order_acquire) > m_mask) return false;
+                m_items[tail & m_mask] = std::move(item);
+                m_tail.store(tail + 1, std::memory_order_release);
+                return true;
+            }
+
+            //returns nullptr when the queue is empty
+            T * front()
+            {
+                auto head = m_head.load(std::memory_order_relaxed);
+                if(head == m_tail.load(std::memory_order_acquire)) return nullptr;
+                return &m_items[head & m_mask];
+            }
+
+            void pop()
+            {
+                auto head = m_head.load(std::memory_order_relaxed);
+                m_items[head & m_mask] = T();//release the item resources on the consumer side
+                m_head.store(head + 1, std::memory_order_release);
+            }
+
+            bool empty() const { return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire); }
+
+        private:
+            static const size_t CACHE_LINE_SIZE = 64;
+            std::vector<T>          m_items;
+            size_t                  m_mask;
+            //the indices are kept on separate cache lines, to avoid false sharing between the producer and the consumer
+            char                    m_head_padding[CACHE_LINE_SIZE];
+            std::atomic<size_t>     m_head;
+            char                    m_tail_padding[CACHE_LINE_SIZE];
+            std::atomic<size_t>     m_tail;
+        };
+    }
+}
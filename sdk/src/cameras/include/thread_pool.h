@@ -0,0 +1,87 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2016 Intel Corporation. All Rights Reserved.
+
+#pragma once
+#include <vector>
+#include <queue>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <future>
+#include <functional>
+#include <condition_variable>
+#include <stdint.h>
+
+namespace rs
+{
+    namespace core
+    {
+        /**
+        * @class thread_pool
+        * @brief Fixed set of worker threads which run the submitted tasks in submission order.
+        *
+        * The tasks that are queued when the pool is destroyed are run before the worker threads exit,
+        * so a future returned by submit is always satisfied.
+        */
+        class thread_pool
+        {
+        public:
+            //threads_count 0 sets one thread per hardware thread
+            explicit thread_pool(uint32_t threads_count) : m_stop(false)
+            {
+                if(threads_count == 0)
+                    threads_count = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+                for(uint32_t i = 0; i < threads_count; i++)
+                    m_threads.push_back(std::thread(&thread_pool::worker_thread, this));
+            }
+
+            ~thread_pool()
+            {
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    m_stop = true;
+                }
+                m_cv.notify_all();
+                for(auto & thread : m_threads)
+                    thread.join();
+            }
+
+            template<typename result>
+            std::future<result> submit(std::function<result()> task)
+            {
+                //packaged_task is move only, it is shared to be held by a copyable function
+                auto packaged_task = std::make_shared<std::packaged_task<result()>>(task);
+                auto future = packaged_task->get_future();
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    m_tasks.push([packaged_task]() { (*packaged_task)(); });
+                }
+                m_cv.notify_one();
+                return future;
+            }
+
+        private:
+            void worker_thread()
+            {
+                for(;;)
+                {
+                    std::function<void()> task;
+                    {
+                        std::unique_lock<std::mutex> guard(m_mutex);
+                        m_cv.wait(guard, [this]() { return m_stop || !m_tasks.empty(); });
+                        if(m_tasks.empty()) return;
+                        task = std::move(m_tasks.front());
+                        m_tasks.pop();
+                    }
+                    task();
+                }
+            }
+
+            std::mutex                              m_mutex;
+            std::condition_variable                 m_cv;
+            std::queue<std::function<void()>>       m_tasks;
+            std::vector<std::thread>                m_threads;
+            bool                                    m_stop;
+        };
+    }
+}
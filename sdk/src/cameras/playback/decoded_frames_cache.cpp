@@ -0,0 +1,58 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2016 Intel Corporation. All Rights Reserved.
+
+#include "decoded_frames_cache.h"
+
+using namespace rs::core;
+using namespace rs::playback;
+
+bool decoded_frames_cache::contains(rs_stream stream, uint32_t index_in_stream) const
+{
+    return m_frames.find(std::make_pair(stream, index_in_stream)) != m_frames.end();
+}
+
+decoded_frames_cache::frame_future decoded_frames_cache::get(rs_stream stream, uint32_t index_in_stream)
+{
+    auto it = m_frames.find(std::make_pair(stream, index_in_stream));
+    if(it == m_frames.end()) return frame_future();
+    auto frame = it->second.frame;
+    if(frame.wait_for(std::chrono::seconds(0)) == std::future_status::ready && !frame.get())
+    {
+        //failed decodes are not kept, the frame is decoded again on the next request
+        erase(it);
+        return frame_future();
+    }
+    m_lru.splice(m_lru.begin(), m_lru, it->second.lru_position);
+    return frame;
+}
+
+void decoded_frames_cache::insert(rs_stream stream, uint32_t index_in_stream, frame_future frame, size_t size)
+{
+    auto key = std::make_pair(stream, index_in_stream);
+    auto it = m_frames.find(key);
+    if(it != m_frames.end())
+        erase(it);
+    if(size > m_max_size) return;
+
+    m_lru.push_front(key);
+    cached_frame entry = { frame, size, m_lru.begin() };
+    m_frames[key] = entry;
+    m_size += size;
+
+    while(m_size > m_max_size)
+        erase(m_frames.find(m_lru.back()));
+}
+
+void decoded_frames_cache::clear()
+{
+    m_lru.clear();
+    m_frames.clear();
+    m_size = 0;
+}
+
+void decoded_frames_cache::erase(std::map<frame_key, cached_frame>::iterator it)
+{
+    m_size -= it->second.size;
+    m_lru.erase(it->second.lru_position);
+    m_frames.erase(it);
+}
@@ -13,6 +13,7 @@ namespace rs
         {
             LOG_FUNC_SCOPE();
             pause();
+            stop_indexing();
         }
 
        core::status disk_read::read_headers()
@@ -25,7 +26,8 @@ namespace rs
             m_file_data_read->read_bytes(&fh, sizeof(fh), num_bytes_read);
             m_file_header = fh.data;
             if (num_bytes_read < sizeof(m_file_header)) return core::status_item_unavailable;
-            if (m_file_header.id != UID('R', 'S', 'L', '2')) return core::status_param_unsupported;
+            if (m_file_header.id != UID('R', 'S', 'L', '2') && m_file_header.id != UID('R', 'S', 'L', '3') &&
+                m_file_header.id != UID('R', 'S', 'L', '4')) return core::status_param_unsupported;
 
             /* Get all chunks */
             for (;;)
@@ -33,7 +35,7 @@ namespace rs
                 core::file_types::chunk_info chunk = {};
                 m_file_data_read->read_bytes(&chunk, sizeof(chunk), num_bytes_read);
                 if (num_bytes_read < sizeof(chunk)) break;
-                if (chunk.id == core::file_types::chunk_id::chunk_sample_info) break;
+                if (chunk.id == core::file_types::chunk_id::chunk_sample_info || chunk.id == core::file_types::chunk_id::chunk_samples_batch) break;
                 num_bytes_to_read = chunk.size;
 
                 switch (chunk.id)
@@ -128,9 +130,130 @@ namespace rs
                 }
                 if (num_bytes_to_read > 0) return core::status_item_unavailable;
             }
+
+            //files of version 2 and records that were not finalized have no trailer
+            if(m_file_header.version >= 3 && fh.trailer_offset > 0)
+                return read_trailer(fh.trailer_offset);
+            return core::status_no_error;
+        }
+
+        core::status disk_read::read_trailer(int64_t trailer_offset)
+        {
+            m_file_data_read->set_position(trailer_offset, core::move_method::begin);
+            uint32_t num_bytes_read = 0;
+            for (;;)
+            {
+                core::file_types::chunk_info chunk = {};
+                m_file_data_read->read_bytes(&chunk, sizeof(chunk), num_bytes_read);
+                if (num_bytes_read < sizeof(chunk)) break;
+                unsigned long num_bytes_to_read = chunk.size;
+
+                switch (chunk.id)
+                {
+                    case core::file_types::chunk_id::chunk_frame_count:
+                    {
+                        std::vector<core::file_types::frame_count> frame_count(chunk.size / sizeof(core::file_types::frame_count));
+                        m_file_data_read->read_bytes(frame_count.data(), chunk.size, num_bytes_read);
+                        for(auto & fc : frame_count)
+                        {
+                            auto it = m_streams_infos.find(fc.stream);
+                            if(it != m_streams_infos.end())
+                                it->second.nframes = fc.nframes;
+                        }
+                        num_bytes_to_read -= num_bytes_read;
+                        LOG_INFO("read frame count chunk " << (num_bytes_to_read == 0 ? "succeeded" : "failed"))
+                    }
+                    break;
+                    case core::file_types::chunk_id::chunk_frame_indexing:
+                    {
+                        std::vector<uint8_t> frame_indexing(num_bytes_to_read);
+                        m_file_data_read->read_bytes(frame_indexing.data(), static_cast<uint32_t>(num_bytes_to_read), num_bytes_read);
+                        num_bytes_to_read -= num_bytes_read;
+                        if(num_bytes_to_read == 0)
+                            read_frame_indexing(frame_indexing);
+                        LOG_INFO("read frame indexing chunk " << (num_bytes_to_read == 0 ? "succeeded" : "failed"))
+                    }
+                    break;
+                    default:
+                        m_file_data_read->set_position(chunk.size, core::move_method::current);
+                        num_bytes_to_read = 0;
+                        LOG_INFO("skip unknown trailer chunk, chunk id - " << chunk.id)
+                }
+                if (num_bytes_to_read > 0) return core::status_item_unavailable;
+            }
+            //the trailer is the last part of the file, clear the end of file state before the next read
+            m_file_data_read->reset();
             return core::status_no_error;
         }
 
+        std::shared_ptr<core::file_types::sample> disk_read::read_index_record(const uint8_t *& it, const uint8_t * end, core::file_types::packed::context & context)
+        {
+            if(m_file_header.version >= 4)
+            {
+                core::file_types::packed::reader reader(it, static_cast<size_t>(end - it));
+                auto sample = core::file_types::packed::read_record(reader, context);
+                it = reader.position();
+                return sample;
+            }
+            core::file_types::sample_info sample_info;
+            if(it + sizeof(sample_info) > end) return nullptr;
+            memcpy(&sample_info, it, sizeof(sample_info));
+            it += sizeof(sample_info);
+            switch(sample_info.type)
+            {
+                case core::file_types::sample_type::st_image:
+                {
+                    core::file_types::frame_info frame_info;
+                    if(it + sizeof(frame_info) > end) return nullptr;
+                    memcpy(&frame_info, it, sizeof(frame_info));
+                    it += sizeof(frame_info);
+                    return std::make_shared<core::file_types::frame_sample>(frame_info, sample_info);
+                }
+                case core::file_types::sample_type::st_motion:
+                {
+                    rs_motion_data motion_data;
+                    if(it + sizeof(motion_data) > end) return nullptr;
+                    memcpy(&motion_data, it, sizeof(motion_data));
+                    it += sizeof(motion_data);
+                    return std::make_shared<core::file_types::motion_sample>(motion_data, sample_info);
+                }
+                case core::file_types::sample_type::st_time:
+                {
+                    rs_timestamp_data time_stamp_data;
+                    if(it + sizeof(time_stamp_data) > end) return nullptr;
+                    memcpy(&time_stamp_data, it, sizeof(time_stamp_data));
+                    it += sizeof(time_stamp_data);
+                    return std::make_shared<core::file_types::time_stamp_sample>(time_stamp_data, sample_info);
+                }
+                default: return nullptr;
+            }
+        }
+
+        void disk_read::read_frame_indexing(const std::vector<uint8_t> &frame_indexing)
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+
+            sample_index samples_index;
+            core::file_types::packed::context context = {};
+            const uint8_t * it = frame_indexing.data();
+            const uint8_t * end = it + frame_indexing.size();
+            while(it < end)
+            {
+                auto sample = read_index_record(it, end, context);
+                if(!sample)
+                {
+                    LOG_ERROR("invalid record in frame indexing chunk, falling back to samples indexing")
+                    return;
+                }
+                samples_index.push_back(sample);
+            }
+
+            //the index is used only if it was fully parsed, otherwise samples are indexed from the file
+            m_samples_index = std::move(samples_index);
+            m_is_index_complete = true;
+            LOG_INFO("samples indexing loaded from file, number of samples - " << m_samples_index.size())
+        }
+
         void disk_read::index_next_samples(uint32_t number_of_samples)
         {
             if (m_is_index_complete) return;
@@ -148,7 +271,17 @@ namespace rs
                     LOG_INFO("samples indexing is done");
                     break;
                 }
-                if(chunk.id == core::file_types::chunk_id::chunk_sample_info)
+                if(chunk.id == core::file_types::chunk_id::chunk_sample_info && m_file_header.version >= 4)
+                {
+                    if(!index_packed_sample(chunk))
+                    {
+                        m_is_index_complete = true;
+                        LOG_ERROR("invalid sample chunk, samples indexing is stopped");
+                        break;
+                    }
+                    ++index;
+                }
+                else if(chunk.id == core::file_types::chunk_id::chunk_sample_info)
                 {
                     core::file_types::disk_format::sample_info si;
                     m_file_indexing->read_bytes(&si, static_cast<uint32_t>(std::min((long unsigned)chunk.size, (unsigned long)sizeof(si))), nbytesRead);
@@ -165,9 +298,7 @@ namespace rs
                             core::file_types::disk_format::frame_info fi = {};
                             m_file_indexing->read_bytes(&fi, static_cast<uint32_t>(std::min((long unsigned)chunk2.size, (unsigned long)sizeof(fi))), nbytesRead);
                             core::file_types::frame_info frame_info = fi.data;
-                            frame_info.index_in_stream = static_cast<uint32_t>(m_image_indices[frame_info.stream].size());
-                            m_image_indices[frame_info.stream].push_back(static_cast<uint32_t>(m_samples_desc.size()));
-                            m_samples_desc.push_back(std::make_shared<core::file_types::frame_sample>(frame_info, sample_info));
+                            m_samples_index.push_frame(frame_info, sample_info);
                             ++index;
                             LOG_VERBOSE("frame sample indexed, sample time - " << sample_info.capture_time)
                             break;
@@ -177,7 +308,7 @@ namespace rs
                             core::file_types::disk_format::motion_data md = {};
                             m_file_indexing->read_bytes(&md, static_cast<uint32_t>(std::min((long unsigned)chunk2.size, (unsigned long)sizeof(md))), nbytesRead);
                             rs_motion_data motion_data = md.data;
-                            m_samples_desc.push_back(std::make_shared<core::file_types::motion_sample>(motion_data, sample_info));
+                            m_samples_index.push_motion(motion_data, sample_info);
                             ++index;
                             LOG_VERBOSE("motion sample indexed, sample time - " << sample_info.capture_time)
                             break;
@@ -187,13 +318,32 @@ namespace rs
                             core::file_types::disk_format::time_stamp_data tsd = {};
                             m_file_indexing->read_bytes(&tsd, static_cast<uint32_t>(std::min((long unsigned)chunk2.size, (unsigned long)sizeof(tsd))), nbytesRead);
                             rs_timestamp_data time_stamp_data = tsd.data;
-                            m_samples_desc.push_back(std::make_shared<core::file_types::time_stamp_sample>(time_stamp_data, sample_info));
+                            m_samples_index.push_time_stamp(time_stamp_data, sample_info);
                             ++index;
                             LOG_VERBOSE("time stamp sample indexed, sample time - " << sample_info.capture_time)
                             break;
                         }
                     }
                 }
+                else if(chunk.id == core::file_types::chunk_id::chunk_samples_batch)
+                {
+                    std::vector<uint8_t> records(chunk.size);
+                    m_file_indexing->read_bytes(records.data(), chunk.size, nbytesRead);
+                    const uint8_t * it = records.data();
+                    const uint8_t * end = it + nbytesRead;
+                    while(it < end)
+                    {
+                        auto sample = read_index_record(it, end, m_packed_context);
+                        if(!sample || sample->info.type == core::file_types::sample_type::st_image)
+                        {
+                            LOG_ERROR("invalid record in samples batch chunk")
+                            break;
+                        }
+                        m_samples_index.push_back(sample);
+                        ++index;
+                    }
+                    LOG_VERBOSE("samples batch indexed, chunk size - " << chunk.size)
+                }
                 else
                 {
                     m_file_indexing->set_position(chunk.size, core::move_method::current);
@@ -202,6 +352,31 @@ namespace rs
             }
         }
 
+        bool disk_read::index_packed_sample(const core::file_types::chunk_info & sample_info_chunk)
+        {
+            uint32_t nbytesRead = 0;
+            std::vector<uint8_t> data(sample_info_chunk.size);
+            m_file_indexing->read_bytes(data.data(), sample_info_chunk.size, nbytesRead);
+            core::file_types::packed::reader sample_info_reader(data.data(), nbytesRead);
+            core::file_types::sample_info sample_info = {};
+            if(!core::file_types::packed::read_sample_info(sample_info_reader, sample_info, m_packed_context)) return false;
+            //motion and time stamp samples are written in samples batch chunks
+            if(sample_info.type != core::file_types::sample_type::st_image) return false;
+
+            core::file_types::chunk_info chunk = {};
+            m_file_indexing->read_bytes(&chunk, sizeof(chunk), nbytesRead);
+            if(chunk.id != core::file_types::chunk_id::chunk_frame_info || chunk.size <= 0) return false;
+            data.resize(chunk.size);
+            m_file_indexing->read_bytes(data.data(), chunk.size, nbytesRead);
+            core::file_types::packed::reader frame_info_reader(data.data(), nbytesRead);
+            core::file_types::frame_info frame_info = {};
+            if(!core::file_types::packed::read_frame_info(frame_info_reader, frame_info, m_packed_context)) return false;
+
+            m_samples_index.push_frame(frame_info, sample_info);
+            LOG_VERBOSE("frame sample indexed, sample time - " << sample_info.capture_time)
+            return true;
+        }
+
         int32_t disk_read::size_of_pitches(void)
         {
             return 0;
@@ -6,15 +6,39 @@
 #include <vector>
 #include "rs/core/metadata_interface.h"
 #include "include/file.h"
+#include "include/mapped_file.h"
+#include "include/packed_format.h"
 #include "rs/utils/log_utils.h"
 #include "rs_sdk_version.h"
+#include <sys/stat.h>
+#include <stdio.h>
 
 using namespace rs::core;
 using namespace rs::playback;
 
+namespace
+{
+    const char * INDEX_CACHE_EXTENSION = ".idx";
+    const uint32_t INDEX_CACHE_VERSION = 1;
+
+    //the sidecar file header, followed by the samples index as packed records
+    struct index_cache_header
+    {
+        int32_t     id;
+        uint32_t    version;
+        uint64_t    file_size;
+        int64_t     file_modification_time;
+        int32_t     file_id;
+        int32_t     file_version;
+        uint64_t    samples_count;
+        uint64_t    records_size;
+    };
+}
+
 disk_read_base::disk_read_base(const char * file_path) : m_file_path(file_path), m_file_header(), m_pause(true),
-    m_realtime(true), m_streams_infos(), m_base_ts(0), m_is_index_complete(false),
-    m_samples_desc_index(0), m_is_motion_tracking_enabled(false)
+    m_realtime(true), m_streams_infos(), m_base_ts(0), m_is_index_complete(false), m_stop_indexing(false), m_is_index_cache_required(false),
+    m_is_index_cache_enabled(true), m_samples_desc_index(0), m_is_motion_tracking_enabled(false), m_decode_lookahead(0),
+    m_decoded_frames_cache(DECODED_FRAMES_CACHE_SIZE), m_pending_neighbour_frames(0), m_last_seek_sample_index(0), m_playback_speed(1)
 {
 
 }
@@ -22,6 +46,9 @@ disk_read_base::disk_read_base(const char * file_path) : m_file_path(file_path),
 disk_read_base::~disk_read_base(void)
 {
     LOG_FUNC_SCOPE();
+    stop_indexing();
+    if(m_is_index_cache_enabled && m_is_index_cache_required && m_is_index_complete)
+        save_index_cache();
 }
 
 rs::playback::file_info disk_read_base::query_file_info()
@@ -41,7 +68,9 @@ rs::playback::file_info disk_read_base::query_file_info()
     {
         case UID('R', 'S', 'C', 'F'): file_info.type = playback::file_format::rs_rssdk_format; break;
         case UID('R', 'S', 'L', '1'):
-        case UID('R', 'S', 'L', '2'): file_info.type = playback::file_format::rs_rssdk_format; break;
+        case UID('R', 'S', 'L', '2'):
+        case UID('R', 'S', 'L', '3'):
+        case UID('R', 'S', 'L', '4'): file_info.type = playback::file_format::rs_rssdk_format; break;
     }
     return file_info;
 }
@@ -53,32 +82,24 @@ capture_mode disk_read_base::get_capture_mode()
     const uint32_t MIN_NUM_OF_FRAMES_TO_VALIDATE = 10;
     std::map<rs_stream,uint64_t> capture_times;
     //index MIN_NUM_OF_FRAMES_TO_VALIDATE samples for each stream type
-    while(!m_is_index_complete)
+    std::unique_lock<std::mutex> guard(m_mutex);
+    wait_for_index(guard, [this]()
     {
-        index_next_samples(NUMBER_OF_SAMPLES_TO_INDEX);
-        if(m_image_indices.size() < m_streams_infos.size())
-            continue;
-
-        bool done = true;
-        for(auto indices : m_image_indices)
+        for(auto stream_info : m_streams_infos)
         {
-            if(indices.second.size() < MIN_NUM_OF_FRAMES_TO_VALIDATE)
-            {
-                done = false;
-            }
+            if(m_samples_index.frames_count(stream_info.first) < MIN_NUM_OF_FRAMES_TO_VALIDATE)
+                return false;
         }
-        if(done)
-            break;
-    }
+        return true;
+    });
 
     //match capture times between the differnt streams
-    for(auto sample_desc : m_samples_desc)
+    for(size_t index = 0; index < m_samples_index.size(); index++)
     {
-        if(sample_desc->info.type != file_types::sample_type::st_image)
+        if(m_samples_index.type(index) != file_types::sample_type::st_image)
             continue;
 
-        auto frame = std::dynamic_pointer_cast<file_types::frame_sample>(sample_desc);
-        capture_times[frame->finfo.stream] = frame->info.capture_time;
+        capture_times[m_samples_index.stream(index)] = m_samples_index.capture_time(index);
         if(capture_times.size() > 0 && capture_times.size() == m_streams_infos.size())
         {
             bool match = true;
@@ -95,12 +116,23 @@ capture_mode disk_read_base::get_capture_mode()
     return capture_mode::asynced;
 }
 
+static status open_read_file(const std::string & file_path, std::unique_ptr<file> & read_file)
+{
+#ifdef __linux__
+    //frames are read from the file mapping without a copy, the stream file is used where mapping is not supported
+    read_file = std::unique_ptr<file>(new mapped_file());
+    if(read_file->open(file_path, open_file_option::read) == status_no_error) return status_no_error;
+    LOG_WARN("failed to map file, file path - " << file_path.c_str())
+#endif
+    read_file = std::unique_ptr<file>(new file());
+    return read_file->open(file_path, open_file_option::read);
+}
+
 status disk_read_base::init()
 {
     if (m_file_path.empty()) return status_file_open_failed;
 
-    m_file_data_read = std::unique_ptr<file>(new file());
-    status init_status = m_file_data_read->open(m_file_path.c_str(), (open_file_option)(open_file_option::read));
+    status init_status = open_read_file(m_file_path, m_file_data_read);
     if (init_status < status_no_error)
     {
         return init_status;
@@ -108,14 +140,20 @@ status disk_read_base::init()
 
     init_status = read_headers();
 
-    m_file_indexing = std::unique_ptr<file>(new file());
-    init_status = m_file_indexing->open(m_file_path.c_str(), (open_file_option)(open_file_option::read));
+    //files of version 2 and records that were not finalized are indexed from the samples
+    if(!m_is_index_complete)
+        m_is_index_cache_required = !load_index_cache();
+
+    init_status = open_read_file(m_file_path, m_file_indexing);
     if (init_status < status_no_error) return init_status;
 
     /* Be prepared to index the frames */
     m_file_indexing->set_position(m_file_header.first_frame_offset, move_method::begin);
     LOG_INFO("init " << (init_status == status_no_error ? "succeeded" : "failed") << "(status - " << init_status << ")");
 
+    if(!m_is_index_complete)
+        m_indexing_thread = std::thread(&disk_read_base::indexing_thread, this);
+
     if(m_file_header.capture_mode == 0)
         m_file_header.capture_mode = get_capture_mode();
 
@@ -141,16 +179,72 @@ void disk_read_base::pause()
 {
     LOG_FUNC_SCOPE();
 
-    m_pause = true;
+    {
+        std::lock_guard<std::mutex> guard(m_time_base_mutex);
+        m_pause = true;
+    }
+    m_time_base_cv.notify_all();
 
     if (m_thread.joinable())
         m_thread.join();
 }
 
+void disk_read_base::indexing_thread()
+{
+    LOG_FUNC_SCOPE();
+    try
+    {
+        while(!m_is_index_complete && !m_stop_indexing)
+        {
+            index_next_samples(NUMBER_OF_SAMPLES_TO_INDEX);
+            m_index_cv.notify_all();
+        }
+    }
+    catch(const std::exception & e)
+    {
+        LOG_ERROR("samples indexing failed - " << e.what())
+        m_is_index_complete = true;
+    }
+    //waiting threads are released by the lock, the index completion may be set while they were checking the index
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+    }
+    m_index_cv.notify_all();
+    LOG_INFO("samples indexing thread is done, number of samples - " << m_samples_index.size())
+}
+
+void disk_read_base::stop_indexing()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_stop_indexing = true;
+    }
+    m_index_cv.notify_all();
+    if(m_indexing_thread.joinable())
+        m_indexing_thread.join();
+}
+
+bool disk_read_base::wait_for_next_sample()
+{
+    std::unique_lock<std::mutex> guard(m_mutex);
+    return wait_for_index(guard, [this]() { return m_samples_desc_index < m_samples_index.size(); });
+}
+
+bool disk_read_base::wait_for_next_lookahead_sample()
+{
+    //the lookahead state is checked under the lock, the decode pool may be replaced by set_decode_lookahead while playing
+    std::unique_lock<std::mutex> guard(m_mutex);
+    if(!is_lookahead_available()) return false;
+    return wait_for_index(guard, [this]() { return m_samples_desc_index < m_samples_index.size(); });
+}
+
 void disk_read_base::read_thread()
 {
     LOG_FUNC_SCOPE();
-    m_base_sys_time = std::chrono::high_resolution_clock::now();
+    {
+        std::lock_guard<std::mutex> guard(m_time_base_mutex);
+        m_base_sys_time = std::chrono::steady_clock::now();
+    }
     auto eof = false;
     while (!m_pause && !eof)
     {
@@ -169,16 +263,56 @@ void disk_read_base::read_thread()
 void disk_read_base::init_decoder()
 {
     std::map<rs_stream,file_types::compression_type> compression_config;
-    uint32_t buffer_size = 0;
     for(auto it = m_active_streams_info.begin(); it != m_active_streams_info.end(); ++it)
     {
-        uint32_t size = it->second.m_stream_info.profile.info.width * it->second.m_stream_info.profile.info.height;
-        buffer_size = size > buffer_size ? size : buffer_size;
         compression_config.emplace(it->first, it->second.m_stream_info.ctype);
     }
 
     m_decoder.reset(new compression::decoder(compression_config));
-    m_encoded_data = std::vector<uint8_t>(buffer_size * 4);//stride is not availabe, taking worst case.
+    set_max_free_frames();
+}
+
+void disk_read_base::set_max_free_frames()
+{
+    //frames are released at the rate they are decoded, the free buffers cover the lookahead window
+    size_t max_free_frames = m_decode_lookahead + buffer_pool::DEFAULT_MAX_FREE_BUFFERS;
+    if(m_decoder)
+        m_decoder->set_max_free_frames(max_free_frames);
+    for(auto it = m_active_streams_info.begin(); it != m_active_streams_info.end(); ++it)
+    {
+        it->second.m_frames_buffer_pool.set_max_free_buffers(max_free_frames);
+        it->second.m_encoded_buffer_pool.set_max_free_buffers(max_free_frames);
+    }
+}
+
+void disk_read_base::set_index_cache(bool enabled)
+{
+    m_is_index_cache_enabled = enabled;
+}
+
+void disk_read_base::set_decode_lookahead(uint32_t frames_count, uint32_t threads_count)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_decode_lookahead = frames_count;
+    //frames that are decoded by the previous pool are completed before it is destroyed
+    m_decode_pool.reset(frames_count > 0 ? new thread_pool(threads_count) : nullptr);
+    set_max_free_frames();
+    LOG_INFO("decode lookahead - " << frames_count << " frames");
+}
+
+uint32_t disk_read_base::get_prefetched_frames_count()
+{
+    uint32_t frames_count = 0;
+    for(auto it = m_active_streams_info.begin(); it != m_active_streams_info.end(); ++it)
+        frames_count += it->second.m_prefetched_samples_count;
+    return frames_count;
+}
+
+bool disk_read_base::is_lookahead_available()
+{
+    //motion samples are bounded as well, for files of motion samples only
+    return m_decode_pool && get_prefetched_frames_count() < m_decode_lookahead &&
+           m_prefetched_samples.size() < m_decode_lookahead + NUMBER_OF_REQUIRED_PREFETCHED_SAMPLES;
 }
 
 void disk_read_base::reset()
@@ -188,12 +322,11 @@ void disk_read_base::reset()
     std::lock_guard<std::mutex> guard(m_mutex);
     m_file_data_read->reset();
     m_samples_desc_index = 0;
-    std::queue<std::shared_ptr<core::file_types::sample>> empty_queue;
+    std::queue<prefetched_sample> empty_queue;
     std::swap(m_prefetched_samples, empty_queue);
     for(auto it = m_active_streams_info.begin(); it != m_active_streams_info.end(); ++it)
     {
         active_stream_info & asi = it->second;
-        asi.m_image_indices = m_image_indices[it->first];
         asi.m_prefetched_samples_count = 0;
         asi.m_stream_info = m_streams_infos[it->first];
     }
@@ -207,7 +340,6 @@ void disk_read_base::enable_stream(rs_stream stream, bool state)
     if(state)
     {
         active_stream_info asi;
-        asi.m_image_indices = m_image_indices[stream];
         asi.m_prefetched_samples_count = 0;
         asi.m_stream_info = m_streams_infos[stream];
         m_active_streams_info[stream] = asi;
@@ -229,36 +361,62 @@ void disk_read_base::notify_available_samples()
     int64_t time_to_next_sample = 0;
     while(!m_pause)
     {
-        std::lock_guard<std::mutex> guard(m_mutex);
+        std::unique_lock<std::mutex> guard(m_mutex);
         if(m_prefetched_samples.empty())break;
-        time_to_next_sample = calc_sleep_time(m_prefetched_samples.front());
+        auto & next = m_prefetched_samples.front();
+        time_to_next_sample = calc_sleep_time(next.sample);
         if(time_to_next_sample > 0 && m_realtime)break;
 
+        if(next.decoded.valid())
+        {
+            //samples are delivered in order, keep reading ahead while the next frame is decoded
+            bool is_prefetch_available = is_lookahead_available() && (m_samples_desc_index < m_samples_index.size() || !m_is_index_complete);
+            if(next.decoded.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            {
+                if(is_prefetch_available) break;
+                //the decode is waited for without the lock, seek requests are not blocked by it, the sample is checked again once decoded
+                auto decoded = next.decoded;
+                guard.unlock();
+                decoded.wait();
+                continue;
+            }
+            auto decoded = next.decoded.get();
+            if(!decoded)
+            {
+                LOG_ERROR("failed to decode frame, sample capture time - " << next.sample->info.capture_time);
+                auto frame = std::dynamic_pointer_cast<file_types::frame_sample>(next.sample);
+                if(frame) m_active_streams_info[frame->finfo.stream].m_prefetched_samples_count--;
+            }
+            next.sample = decoded;
+        }
+
         //handle next sample if its time has come
-        if(m_prefetched_samples.front()->info.type == file_types::sample_type::st_image)
+        auto sample = next.sample;
+        m_prefetched_samples.pop();
+        if(!sample) continue;
+        if(sample->info.type == file_types::sample_type::st_image)
         {
-            auto frame = std::dynamic_pointer_cast<file_types::frame_sample>(m_prefetched_samples.front());
+            auto frame = std::dynamic_pointer_cast<file_types::frame_sample>(sample);
             if (frame)
             {
                 m_active_streams_info[frame->finfo.stream].m_prefetched_samples_count--;
                 LOG_VERBOSE("calling callback, frame stream type - " << frame->finfo.stream);
             }
         }
-        LOG_VERBOSE("calling callback, sample type - " << m_prefetched_samples.front()->info.type);
-        LOG_VERBOSE("calling callback, sample capture time - " << m_prefetched_samples.front()->info.capture_time);
-        m_sample_callback(m_prefetched_samples.front());
-        m_prefetched_samples.pop();
+        LOG_VERBOSE("calling callback, sample type - " << sample->info.type);
+        LOG_VERBOSE("calling callback, sample capture time - " << sample->info.capture_time);
+        m_sample_callback(sample);
     }
 }
 
 void disk_read_base::prefetch_sample()
 {
-    if(m_samples_desc_index >= m_samples_desc.size() || all_samples_bufferd())
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if(m_samples_desc_index >= m_samples_index.size() || (all_samples_bufferd() && !is_lookahead_available()))
         return;
     LOG_VERBOSE("process sample - " << m_samples_desc_index);
-    auto sample = m_samples_desc[m_samples_desc_index];
+    auto sample = m_samples_index.at(m_samples_desc_index);
     m_samples_desc_index++;
-    std::lock_guard<std::mutex> guard(m_mutex);
     if(sample->info.type == file_types::sample_type::st_image)
     {
         auto frame = std::dynamic_pointer_cast<file_types::frame_sample>(sample);
@@ -266,18 +424,44 @@ void disk_read_base::prefetch_sample()
         {
             //don't prefatch frame if stream is disabled.
             if(m_active_streams_info.find(frame->finfo.stream) == m_active_streams_info.end()) return;
-            auto curr = read_image_buffer(frame);
-            if(curr)
+            prefetched_sample prefetched;
+            //the frame may be decoded already, by a seek request or as its neighbour
+            auto cached = m_decoded_frames_cache.get(frame->finfo.stream, frame->finfo.index_in_stream);
+            if(cached.valid())
+            {
+                //a frame which is still decoded is waited for when it is notified, without the lock
+                prefetched.sample = frame;
+                prefetched.decoded = cached;
+            }
+            else if(m_decode_pool)
+            {
+                //the frame is read here and decoded by the pool, the frame descriptor holds its place in the queue
+                auto decode = read_image(frame);
+                if(decode)
+                {
+                    prefetched.sample = frame;
+                    prefetched.decoded = m_decode_pool->submit(decode).share();
+                }
+            }
+            else
+            {
+                prefetched.sample = read_image_buffer(frame);
+            }
+            if(prefetched.sample)
             {
                 m_active_streams_info[frame->finfo.stream].m_prefetched_samples_count++;
-                m_prefetched_samples.push(curr);
+                m_prefetched_samples.push(std::move(prefetched));
             }
         }
     }
     else
     {
         if(m_is_motion_tracking_enabled)
-            m_prefetched_samples.push(sample);
+        {
+            prefetched_sample prefetched;
+            prefetched.sample = sample;
+            m_prefetched_samples.push(std::move(prefetched));
+        }
     }
     LOG_VERBOSE("sample prefetched, sample type - " << sample->info.type);
     LOG_VERBOSE("sample prefetched, sample capture time - " << sample->info.capture_time);
@@ -287,33 +471,31 @@ bool disk_read_base::read_next_sample()
 {
     //indicate to device all samples which time elapsed (timestamp is in the past of the playback clock)
     notify_available_samples();
-    while(m_samples_desc_index >= m_samples_desc.size() && !m_is_index_complete)
-        index_next_samples(NUMBER_OF_SAMPLES_TO_INDEX);
-    if(m_samples_desc_index >= m_samples_desc.size() && m_prefetched_samples.size() == 0)
+    if(!wait_for_next_sample() && m_prefetched_samples.size() == 0)
         return false;
     //optimize next reads - prefetch a single sample.
     //This sample will be indicated to the device on the next iteration of the calling function if its time arrived.
-    //Can't fetch more than 1 sample without checking if need to indicate any sample from the prefetched queue
+    //Can't fetch more than 1 sample without checking if need to indicate any sample from the prefetched queue,
+    //unless frames are decoded by the pool, in which case the lookahead window is filled, the samples are indicated once decoded.
     prefetch_sample();
+    while(!m_pause && wait_for_next_lookahead_sample())
+        prefetch_sample();
     //goto sleep in case we have at least one frame ready for each stream, and playing in realtime
-    if(all_samples_bufferd() && m_realtime)
+    std::shared_ptr<file_types::sample> next_sample;
     {
-        int64_t time_to_next_sample;
-        while((time_to_next_sample  = calc_sleep_time(m_prefetched_samples.front())) > 1e3)
-        {
-            if(m_is_index_complete)
-                std::this_thread::sleep_for(std::chrono::microseconds(time_to_next_sample));
-            else
-               index_next_samples(NUMBER_OF_SAMPLES_TO_INDEX);
-        }
+        std::lock_guard<std::mutex> guard(m_mutex);
+        if(all_samples_bufferd() && !m_prefetched_samples.empty())
+            next_sample = m_prefetched_samples.front().sample;
     }
+    if(next_sample && m_realtime)
+        wait_for_sample_time(next_sample);
     return true;
 }
 
 bool disk_read_base::all_samples_bufferd()
 {
     //no more samples to prefetch - all available samples are buffered
-    if(m_is_index_complete && m_samples_desc_index >= m_samples_desc.size() && m_prefetched_samples.size() > 0) return true;
+    if(m_is_index_complete && m_samples_desc_index >= m_samples_index.size() && m_prefetched_samples.size() > 0) return true;
 
     for(auto it = m_active_streams_info.begin(); it != m_active_streams_info.end(); ++it)
     {
@@ -342,17 +524,19 @@ bool disk_read_base::is_stream_profile_available(rs_stream stream, int width, in
 std::map<rs_stream, std::shared_ptr<rs::core::file_types::frame_sample>> disk_read_base::set_frame_by_index(uint32_t index, rs_stream stream_type)
 {
     std::map<rs_stream, std::shared_ptr<rs::core::file_types::frame_sample>> rv;
-    auto previous_state = m_pause;
+    bool previous_state = m_pause;
 
     pause();
 
-    while(index >= m_image_indices[stream_type].size() && !m_is_index_complete) index_next_samples(NUMBER_OF_SAMPLES_TO_INDEX);
-
-    if (index >= m_image_indices[stream_type].size()) return rv;
-
+    uint32_t sample_index = 0;
+    {
+        std::unique_lock<std::mutex> guard(m_mutex);
+        if(!wait_for_index(guard, [this, index, stream_type]() { return index < m_samples_index.frames_count(stream_type); })) return rv;
+        sample_index = m_samples_index.frame_sample_index(stream_type, index);
+    }
 
     //return current frames for all streams.
-    rv = find_nearest_frames(m_image_indices[stream_type][index], stream_type);
+    rv = find_nearest_frames(sample_index, stream_type);
 
     LOG_VERBOSE("set index to - " << index << " ,stream - " << stream_type);
 
@@ -365,34 +549,30 @@ std::map<rs_stream, std::shared_ptr<rs::core::file_types::frame_sample>> disk_re
 std::map<rs_stream, std::shared_ptr<rs::core::file_types::frame_sample>> disk_read_base::set_frame_by_time_stamp(uint64_t ts)
 {
     std::map<rs_stream, std::shared_ptr<core::file_types::frame_sample>> rv;
-    auto previous_state = m_pause;
+    bool previous_state = m_pause;
 
     pause();
     rs_stream stream = rs_stream::RS_STREAM_COUNT;
     uint32_t index = 0;
     // Index the streams until we have at least a stream whose time stamp is bigger than ts.
-    do
+    // Samples are indexed in file order, the first such frame in the file is the earliest of the streams first such frames.
     {
-        if(index >= m_samples_desc.size())
+        std::unique_lock<std::mutex> guard(m_mutex);
+        auto is_indexed = wait_for_index(guard, [this, ts, &stream, &index]()
         {
-            if(m_is_index_complete)return rv;
-            index_next_samples(NUMBER_OF_SAMPLES_TO_INDEX);
-        }
-        {
-            if(index >= m_samples_desc.size())continue;
-            std::lock_guard<std::mutex> guard(m_mutex);
-            if(m_samples_desc[index]->info.type != file_types::sample_type::st_image)continue;
-            auto frame = std::dynamic_pointer_cast<file_types::frame_sample>(m_samples_desc[index]);
-            if(frame->finfo.time_stamp >= ts)
+            for(auto it = m_streams_infos.begin(); it != m_streams_infos.end(); ++it)
             {
-                stream = frame->finfo.stream;
-                break;
+                auto frame_index = m_samples_index.find_frame_by_time_stamp(it->first, static_cast<double>(ts));
+                if(frame_index >= m_samples_index.frames_count(it->first)) continue;
+                auto sample_index = m_samples_index.frame_sample_index(it->first, frame_index);
+                if(stream != rs_stream::RS_STREAM_COUNT && sample_index >= index) continue;
+                stream = it->first;
+                index = sample_index;
             }
-        }
+            return stream != rs_stream::RS_STREAM_COUNT;
+        });
+        if(!is_indexed) return rv;
     }
-    while(++index);
-
-    if(stream == rs_stream::RS_STREAM_COUNT) return rv;
 
 
     //return current frames for all streams.
@@ -410,63 +590,64 @@ std::map<rs_stream, std::shared_ptr<file_types::frame_sample> > disk_read_base::
 {
     std::map<rs_stream, std::shared_ptr<core::file_types::frame_sample>> rv;
 
-    std::map<rs_stream, uint64_t> prev_index;
-    std::map<rs_stream, uint64_t> next_index;
-    auto index = sample_index;
-    while(index > 0 && prev_index.size() < m_active_streams_info.size())
+    //wait until each of the active streams has a frame after the sample, or until the end of the file is indexed
+    uint64_t capture_time = 0;
     {
-        index--;
-        if(m_samples_desc[index]->info.type != file_types::sample_type::st_image)continue;
-        auto frame = std::dynamic_pointer_cast<file_types::frame_sample>(m_samples_desc[index]);
-        if(prev_index.find(frame->finfo.stream) != prev_index.end())continue;
-        prev_index[frame->finfo.stream] = index;
-    }
-    index = sample_index;
-    while(next_index.size() < m_active_streams_info.size())
-    {
-        if(index + 1 >= m_samples_desc.size())
+        std::unique_lock<std::mutex> guard(m_mutex);
+        for(auto it = m_active_streams_info.begin(); it != m_active_streams_info.end(); ++it)
         {
-            if(m_is_index_complete)break;
-            index_next_samples(NUMBER_OF_SAMPLES_TO_INDEX);
+            auto stream_type = it->first;
+            wait_for_index(guard, [this, stream_type, sample_index]()
+            {
+                return m_samples_index.find_frame_by_sample_index(stream_type, sample_index + 1) < m_samples_index.frames_count(stream_type);
+            });
         }
-        if(index + 1 >= m_samples_desc.size())continue;
-        index++;
-        if(m_samples_desc[index]->info.type != file_types::sample_type::st_image)continue;
-        auto frame = std::dynamic_pointer_cast<file_types::frame_sample>(m_samples_desc[index]);
-        if(next_index.find(frame->finfo.stream) != next_index.end())continue;
-        next_index[frame->finfo.stream] = index;
-    }
-    auto capture_time = m_samples_desc[sample_index]->info.capture_time;
+        capture_time = m_samples_index.capture_time(sample_index);
+    }
     for(auto it = m_active_streams_info.begin(); it != m_active_streams_info.end(); ++it)
     {
-        std::lock_guard<std::mutex> guard(m_mutex);
+        std::unique_lock<std::mutex> guard(m_mutex);
 
         std::shared_ptr<file_types::sample> sample;
         if(it->first == stream)
-            sample = m_samples_desc[sample_index];
+            sample = m_samples_index.at(sample_index);
         else
         {
-            auto prev = capture_time > m_samples_desc[prev_index[it->first]]->info.capture_time ?
-                (capture_time - m_samples_desc[prev_index[it->first]]->info.capture_time ):
-                ( m_samples_desc[prev_index[it->first]]->info.capture_time - capture_time );
-            auto next = capture_time > m_samples_desc[next_index[it->first]]->info.capture_time ?
-                capture_time - m_samples_desc[next_index[it->first]]->info.capture_time :
-                m_samples_desc[next_index[it->first]]->info.capture_time - capture_time;
-            sample = prev > next ? m_samples_desc[next_index[it->first]] : m_samples_desc[prev_index[it->first]];
+            //the stream frame nearest to the sample capture time, out of the frames before and after the sample
+            auto frames_count = m_samples_index.frames_count(it->first);
+            if(frames_count == 0) continue;
+            auto next = m_samples_index.find_frame_by_sample_index(it->first, sample_index + 1);
+            auto frame_index = next;
+            if(next == frames_count)
+                frame_index = next - 1;
+            else if(next > 0)
+            {
+                auto prev_capture_time = m_samples_index.capture_time(m_samples_index.frame_sample_index(it->first, next - 1));
+                auto next_capture_time = m_samples_index.capture_time(m_samples_index.frame_sample_index(it->first, next));
+                auto prev_distance = capture_time > prev_capture_time ? capture_time - prev_capture_time : prev_capture_time - capture_time;
+                auto next_distance = capture_time > next_capture_time ? capture_time - next_capture_time : next_capture_time - capture_time;
+                if(prev_distance <= next_distance) frame_index = next - 1;
+            }
+            sample = m_samples_index.at(m_samples_index.frame_sample_index(it->first, frame_index));
         }
         auto frame = std::dynamic_pointer_cast<file_types::frame_sample>(sample);
         if (frame)
         {
-            auto curr = read_image_buffer(frame);
+            auto curr = read_cached_frame(guard, frame);
             if(curr)
                 rv[frame->finfo.stream] = curr;
         }
     }
+    //stepping and scrubbing usually continue in the same direction, the next frames in that direction are decoded ahead
+    bool is_forward = sample_index >= m_last_seek_sample_index;
+    m_last_seek_sample_index = sample_index;
+    for(auto it = rv.begin(); it != rv.end(); ++it)
+        prefetch_neighbour_frames(it->first, it->second->finfo.index_in_stream, is_forward);
     {
         std::lock_guard<std::mutex> guard(m_mutex);
         m_samples_desc_index = sample_index;
     }
-    std::queue<std::shared_ptr<core::file_types::sample>> empty_queue;
+    std::queue<prefetched_sample> empty_queue;
     std::swap(m_prefetched_samples, empty_queue);
     prefetch_sample();
     LOG_VERBOSE("update " << rv.size() << " frames");
@@ -489,46 +670,201 @@ uint32_t disk_read_base::query_number_of_frames(rs_stream stream_type)
     if (nframes > 0) return nframes;
 
     /* If not able to get from the header, let's count */
-    while (!m_is_index_complete) index_next_samples(std::numeric_limits<uint32_t>::max());
+    std::unique_lock<std::mutex> guard(m_mutex);
+    wait_for_index(guard, []() { return false; });
+    return m_samples_index.frames_count(stream_type);
+}
+
+bool disk_read_base::query_file_stat(uint64_t & size, int64_t & modification_time)
+{
+    struct stat file_stat = {};
+    if(stat(m_file_path.c_str(), &file_stat) != 0) return false;
+    size = static_cast<uint64_t>(file_stat.st_size);
+#ifdef __linux__
+    modification_time = static_cast<int64_t>(file_stat.st_mtim.tv_sec) * 1000000000 + static_cast<int64_t>(file_stat.st_mtim.tv_nsec);
+#else
+    modification_time = static_cast<int64_t>(file_stat.st_mtime) * 1000000000;
+#endif
+    return true;
+}
+
+bool disk_read_base::load_index_cache()
+{
+    index_cache_header header = {};
+    if(!query_file_stat(header.file_size, header.file_modification_time)) return false;
+
+    file cache_file;
+    if(cache_file.open(m_file_path + INDEX_CACHE_EXTENSION, open_file_option::read) != status_no_error) return false;
+    index_cache_header cache_header = {};
+    uint32_t num_bytes_read = 0;
+    cache_file.read_bytes(&cache_header, sizeof(cache_header), num_bytes_read);
+    if(num_bytes_read < sizeof(cache_header) || cache_header.id != UID('R', 'S', 'I', 'X') || cache_header.version != INDEX_CACHE_VERSION ||
+       cache_header.file_size != header.file_size || cache_header.file_modification_time != header.file_modification_time ||
+       cache_header.file_id != m_file_header.id || cache_header.file_version != m_file_header.version)
+    {
+        LOG_INFO("index cache doesn't match the file, file path - " << m_file_path.c_str())
+        return false;
+    }
+
+    //the sizes are validated against the cache file before allocating, each record takes at least one byte
+    uint64_t cache_size = 0;
+    if(cache_file.set_position(0, move_method::end, &cache_size) != status_no_error ||
+       cache_header.records_size > cache_size - sizeof(cache_header) || cache_header.samples_count > cache_header.records_size ||
+       cache_file.set_position(sizeof(cache_header), move_method::begin) != status_no_error)
+    {
+        LOG_ERROR("invalid index cache size, file path - " << m_file_path.c_str())
+        return false;
+    }
+
+    std::vector<uint8_t> records(static_cast<size_t>(cache_header.records_size));
+    cache_file.read_bytes(records.data(), static_cast<uint32_t>(records.size()), num_bytes_read);
+    if(num_bytes_read < records.size()) return false;
 
-    return (int32_t)m_image_indices[stream_type].size();
+    sample_index samples_index;
+    file_types::packed::context context = {};
+    file_types::packed::reader reader(records.data(), records.size());
+    samples_index.reserve(static_cast<size_t>(cache_header.samples_count));
+    while(!reader.is_end())
+    {
+        auto sample = file_types::packed::read_record(reader, context);
+        if(!sample)
+        {
+            LOG_ERROR("invalid record in index cache, file path - " << m_file_path.c_str())
+            return false;
+        }
+        samples_index.push_back(sample);
+    }
+    if(samples_index.size() != cache_header.samples_count) return false;
+
+    m_samples_index = std::move(samples_index);
+    m_is_index_complete = true;
+    LOG_INFO("samples indexing loaded from index cache, number of samples - " << m_samples_index.size())
+    return true;
+}
+
+void disk_read_base::save_index_cache()
+{
+    index_cache_header header = {};
+    if(!query_file_stat(header.file_size, header.file_modification_time)) return;
+
+    std::vector<uint8_t> records;
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        file_types::packed::writer writer(records);
+        file_types::packed::context context = {};
+        for(size_t index = 0; index < m_samples_index.size(); index++)
+            file_types::packed::write_record(writer, m_samples_index.at(index), context);
+        header.samples_count = m_samples_index.size();
+    }
+    header.id = UID('R', 'S', 'I', 'X');
+    header.version = INDEX_CACHE_VERSION;
+    header.file_id = m_file_header.id;
+    header.file_version = m_file_header.version;
+    header.records_size = records.size();
+
+    //the cache is written aside and renamed, so other readers of the file never load a partial cache
+    auto cache_path = m_file_path + INDEX_CACHE_EXTENSION;
+    auto temp_path = cache_path + ".tmp";
+    {
+        file cache_file;
+        uint32_t num_bytes_written = 0, records_bytes_written = 0;
+        if(cache_file.open(temp_path, open_file_option::write) != status_no_error ||
+           cache_file.write_bytes(&header, sizeof(header), num_bytes_written) != status_no_error ||
+           cache_file.write_bytes(records.data(), static_cast<uint32_t>(records.size()), records_bytes_written) != status_no_error)
+        {
+            LOG_WARN("failed to write index cache, file path - " << cache_path.c_str())
+            cache_file.close();
+            remove(temp_path.c_str());
+            return;
+        }
+    }
+    //rename doesn't replace an existing file on windows
+    if(rename(temp_path.c_str(), cache_path.c_str()) != 0 && (remove(cache_path.c_str()) != 0 || rename(temp_path.c_str(), cache_path.c_str()) != 0))
+    {
+        LOG_WARN("failed to write index cache, file path - " << cache_path.c_str())
+        remove(temp_path.c_str());
+        return;
+    }
+    LOG_INFO("samples indexing saved to index cache, number of samples - " << header.samples_count)
+}
+
+bool disk_read_base::set_playback_speed(double speed)
+{
+    if(speed < MIN_PLAYBACK_SPEED || speed > MAX_PLAYBACK_SPEED)
+    {
+        LOG_ERROR("unsupported playback speed - " << speed);
+        return false;
+    }
+    //the time base is moved to the current sample, so the speed applies from the current sample on
+    update_time_base();
+    {
+        std::lock_guard<std::mutex> guard(m_time_base_mutex);
+        m_playback_speed = speed;
+    }
+    m_time_base_cv.notify_all();
+    LOG_INFO("playback speed - " << speed);
+    return true;
+}
+
+double disk_read_base::query_playback_speed()
+{
+    std::lock_guard<std::mutex> guard(m_time_base_mutex);
+    return m_playback_speed;
 }
 
 uint64_t disk_read_base::query_run_time()
 {
-    auto now = std::chrono::high_resolution_clock::now();
+    std::lock_guard<std::mutex> guard(m_time_base_mutex);
+    auto now = std::chrono::steady_clock::now();
     return std::chrono::duration_cast<std::chrono::microseconds>(now - m_base_sys_time).count();
 }
 
+std::chrono::steady_clock::time_point disk_read_base::get_sample_time(const std::shared_ptr<file_types::sample> & sample)
+{
+    auto distance = static_cast<double>(static_cast<int64_t>(sample->info.capture_time - m_base_ts)) / m_playback_speed;
+    return m_base_sys_time + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::micro>(distance));
+}
+
+void disk_read_base::wait_for_sample_time(const std::shared_ptr<file_types::sample> & sample)
+{
+    std::unique_lock<std::mutex> guard(m_time_base_mutex);
+    for(;;)
+    {
+        auto sample_time = get_sample_time(sample);
+        if(m_pause || std::chrono::steady_clock::now() >= sample_time) return;
+        m_time_base_cv.wait_until(guard, sample_time);
+    }
+}
+
 int64_t disk_read_base::calc_sleep_time(std::shared_ptr<file_types::sample> sample)
 {
-    auto time_span = query_run_time();
-    auto time_stamp = sample->info.capture_time;
-    //number of miliseconds to wait - the diff in milisecond between the last call for streaming resume
-    //and the recorded time.
-    int wait_for = static_cast<int>(time_stamp - m_base_ts - time_span);
-    LOG_VERBOSE("sleep length " << wait_for << " miliseconds");
-    LOG_VERBOSE("total run time - " << time_span);
+    std::lock_guard<std::mutex> guard(m_time_base_mutex);
+    //number of microseconds to wait - the sample time on the playback clock, relative to now
+    auto wait_for = std::chrono::duration_cast<std::chrono::microseconds>(get_sample_time(sample) - std::chrono::steady_clock::now()).count();
+    LOG_VERBOSE("sleep length " << wait_for << " microseconds");
     return wait_for;
 }
 
 void disk_read_base::update_time_base()
 {
-    m_base_sys_time = std::chrono::high_resolution_clock::now();
-
     std::lock_guard<std::mutex> guard(m_mutex);
+    uint64_t base_ts = 0;
     if(m_samples_desc_index > 0)
     {
         if(m_prefetched_samples.size() > 0)
-            m_base_ts = m_prefetched_samples.front()->info.capture_time;
+            base_ts = m_prefetched_samples.front().sample->info.capture_time;
         else
-            m_base_ts = m_samples_desc_index < m_samples_desc.size() ?
-                        m_samples_desc[m_samples_desc_index]->info.capture_time : 0;
+            base_ts = m_samples_desc_index < m_samples_index.size() ?
+                      m_samples_index.capture_time(m_samples_desc_index) : 0;
     }
-    else
-        m_base_ts = 0;
+    {
+        std::lock_guard<std::mutex> time_base_guard(m_time_base_mutex);
+        m_base_sys_time = std::chrono::steady_clock::now();
+        m_base_ts = base_ts;
+    }
+    m_time_base_cv.notify_all();
 
-    LOG_VERBOSE("new time base - " << m_base_ts);
+    LOG_VERBOSE("new time base - " << base_ts);
 }
 
 file_types::version disk_read_base::query_sdk_version()
@@ -541,7 +877,82 @@ file_types::version disk_read_base::query_librealsense_version()
     return m_sw_info.librealsense;
 }
 
+bool disk_read_base::is_aligned(const uint8_t * data, int bpp)
+{
+    //pixels of multi byte formats are accessed as 16 or 32 bit words
+    uintptr_t alignment = bpp % 4 == 0 ? 4 : bpp % 2 == 0 ? 2 : 1;
+    return reinterpret_cast<uintptr_t>(data) % alignment == 0;
+}
+
 std::shared_ptr<file_types::frame_sample> disk_read_base::read_image_buffer(std::shared_ptr<file_types::frame_sample> &frame)
+{
+    auto decode = read_image(frame);
+    return decode ? decode() : nullptr;
+}
+
+std::shared_ptr<file_types::frame_sample> disk_read_base::read_cached_frame(std::unique_lock<std::mutex> & guard, std::shared_ptr<file_types::frame_sample> &frame)
+{
+    auto stream = frame->finfo.stream;
+    auto index_in_stream = frame->finfo.index_in_stream;
+    auto cached = m_decoded_frames_cache.get(stream, index_in_stream);
+    if(cached.valid())
+    {
+        //a neighbour frame may still be decoded, the indexing thread isn't blocked while it is waited for
+        if(cached.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            guard.unlock();
+            cached.wait();
+            guard.lock();
+        }
+        auto decoded = cached.get();
+        if(decoded) return decoded;
+    }
+
+    auto decoded = read_image_buffer(frame);
+    if(decoded)
+    {
+        std::promise<std::shared_ptr<file_types::frame_sample>> promise;
+        promise.set_value(decoded);
+        m_decoded_frames_cache.insert(stream, index_in_stream, promise.get_future().share(), static_cast<size_t>(decoded->finfo.stride * decoded->finfo.height));
+    }
+    return decoded;
+}
+
+void disk_read_base::prefetch_neighbour_frames(rs_stream stream, uint32_t index_in_stream, bool is_forward)
+{
+    if(!m_neighbour_frames_pool)
+        m_neighbour_frames_pool.reset(new thread_pool(1));
+
+    //queued decodes can't be cancelled, the queue is bounded to a window of neighbours per stream. while scrubbing fast,
+    //the decodes of earlier seeks and the encoded data they hold don't pile up, and a step doesn't wait behind all of them
+    auto max_pending_frames = NUMBER_OF_PREFETCHED_NEIGHBOUR_FRAMES * static_cast<uint32_t>(m_active_streams_info.size());
+    for(uint32_t i = 1; i <= NUMBER_OF_PREFETCHED_NEIGHBOUR_FRAMES; i++)
+    {
+        if(!is_forward && i > index_in_stream) break;
+        auto neighbour_index = is_forward ? index_in_stream + i : index_in_stream - i;
+
+        std::lock_guard<std::mutex> guard(m_mutex);
+        if(neighbour_index >= m_samples_index.frames_count(stream)) break;
+        if(m_decoded_frames_cache.get(stream, neighbour_index).valid()) continue;
+        if(m_pending_neighbour_frames >= max_pending_frames) break;
+        auto frame = std::dynamic_pointer_cast<file_types::frame_sample>(m_samples_index.at(m_samples_index.frame_sample_index(stream, neighbour_index)));
+        if(!frame) continue;
+        //the frame is read here, the file is not accessed by the pool
+        auto decode = read_image(frame);
+        if(!decode) continue;
+        m_pending_neighbour_frames++;
+        auto pending_frames = &m_pending_neighbour_frames;
+        std::function<std::shared_ptr<file_types::frame_sample>()> pending_decode = [decode, pending_frames]()
+        {
+            auto decoded = decode();
+            (*pending_frames)--;
+            return decoded;
+        };
+        m_decoded_frames_cache.insert(stream, neighbour_index, m_neighbour_frames_pool->submit(pending_decode).share(), static_cast<size_t>(frame->finfo.stride * frame->finfo.height));
+    }
+}
+
+std::function<std::shared_ptr<file_types::frame_sample>()> disk_read_base::read_image(std::shared_ptr<file_types::frame_sample> &frame)
 {
     status sts = m_file_data_read->set_position(frame->info.offset, move_method::begin);
 
@@ -577,21 +988,55 @@ std::shared_ptr<file_types::frame_sample> disk_read_base::read_image_buffer(std:
                 {
                     case file_types::compression_type::none:
                     {
+#ifdef __linux__
+                        //the frame data is a view of the file mapping, which is kept alive by the frame
+                        auto mapped_file = dynamic_cast<core::mapped_file*>(m_file_data_read.get());
+                        auto view = mapped_file ? mapped_file->read_view(static_cast<uint32_t>(num_bytes_to_read)) : nullptr;
+                        if(view && is_aligned(view.get(), frame->finfo.bpp))
+                        {
+                            auto rv = std::shared_ptr<file_types::frame_sample>(
+                            new file_types::frame_sample(frame.get()), [view](file_types::frame_sample* f) { delete f; });
+                            rv->data = view.get();
+                            return [rv]() { return rv; };
+                        }
+                        if(view)
+                            m_file_data_read->set_position(-static_cast<int64_t>(num_bytes_to_read), move_method::current);
+#endif
+                        auto buffer = m_active_streams_info[frame->finfo.stream].m_frames_buffer_pool.acquire(num_bytes_to_read);
                         auto rv = std::shared_ptr<file_types::frame_sample>(
-                        new file_types::frame_sample(frame.get()), [](file_types::frame_sample* f) { delete[] f->data; delete f;});
-                        auto data = new uint8_t[num_bytes_to_read];
-                        m_file_data_read->read_bytes(data, static_cast<uint32_t>(num_bytes_to_read), num_bytes_read);
+                        new file_types::frame_sample(frame.get()), [buffer](file_types::frame_sample* f) { delete f; });
+                        m_file_data_read->read_bytes(buffer.get(), static_cast<uint32_t>(num_bytes_to_read), num_bytes_read);
                         num_bytes_to_read -= num_bytes_read;
-                        rv->data = data;
-                        return rv;
+                        rv->data = buffer.get();
+                        return [rv]() { return rv; };
                     }
                     case file_types::compression_type::lz4:
+                    case file_types::compression_type::z16_lz4:
+                    case file_types::compression_type::jpeg:
+                    case file_types::compression_type::lz4_striped:
                     case file_types::compression_type::h264:
                     {
-                        uint8_t * data = m_encoded_data.data();
-                        m_file_data_read->read_bytes(data, static_cast<uint32_t>(num_bytes_to_read), num_bytes_read);
-                        auto rv = m_decoder->decode_frame(frame, data, num_bytes_read);
-                        return rv;
+                        std::shared_ptr<const uint8_t> encoded_data;
+#ifdef __linux__
+                        //decompress directly from the file mapping
+                        auto mapped_file = dynamic_cast<core::mapped_file*>(m_file_data_read.get());
+                        if(mapped_file)
+                            encoded_data = mapped_file->read_view(static_cast<uint32_t>(num_bytes_to_read));
+#endif
+                        if(!encoded_data)
+                        {
+                            auto buffer = m_active_streams_info[frame->finfo.stream].m_encoded_buffer_pool.acquire(num_bytes_to_read);
+                            m_file_data_read->read_bytes(buffer.get(), static_cast<uint32_t>(num_bytes_to_read), num_bytes_read);
+                            encoded_data = buffer;
+                        }
+                        //the decode may run on another thread, it holds a copy of the frame info and metadata, and its own references
+                        auto decoder = m_decoder;
+                        auto frame_info = std::make_shared<file_types::frame_sample>(frame.get());
+                        auto encoded_size = static_cast<uint32_t>(num_bytes_to_read);
+                        return [decoder, frame_info, encoded_data, encoded_size]()
+                        {
+                            return decoder->decode_frame(frame_info, encoded_data.get(), encoded_size);
+                        };
                     }
                     default:
                     {
@@ -0,0 +1,59 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2016 Intel Corporation. All Rights Reserved.
+
+#pragma once
+#include <list>
+#include <map>
+#include <memory>
+#include <future>
+#include <librealsense/rs.hpp>
+#include "include/file_types.h"
+
+namespace rs
+{
+    namespace playback
+    {
+        /**
+        * @class decoded_frames_cache
+        * @brief Least recently used cache of decoded frames, bounded by the size of the frames data.
+        *
+        * A frame is identified by its stream and its index in the stream.
+        * Frames can be cached while they are decoded, the cache returns the frame future and doesn't wait for the decode.
+        * The cache isn't thread safe, the playback accesses it under the disk_read_base mutex, by the seek methods and by the read thread.
+        * Decodes are waited for after the mutex is released.
+        */
+        class decoded_frames_cache
+        {
+        public:
+            typedef std::shared_future<std::shared_ptr<core::file_types::frame_sample>> frame_future;
+
+            explicit decoded_frames_cache(size_t max_size) : m_size(0), m_max_size(max_size) {}
+
+            bool contains(rs_stream stream, uint32_t index_in_stream) const;
+            //returns an invalid future if the frame is not cached or failed to decode, otherwise the frame becomes the most recently used.
+            //the returned frame may still be decoded, a decode which completes with nullptr is removed by the next get.
+            frame_future get(rs_stream stream, uint32_t index_in_stream);
+            //the size is the frame data size, the least recently used frames are removed until the cache fits its maximal size
+            void insert(rs_stream stream, uint32_t index_in_stream, frame_future frame, size_t size);
+            void clear();
+
+            size_t size() const { return m_size; }
+
+        private:
+            typedef std::pair<rs_stream, uint32_t> frame_key;
+            struct cached_frame
+            {
+                frame_future                    frame;
+                size_t                          size;
+                std::list<frame_key>::iterator  lru_position;
+            };
+
+            void erase(std::map<frame_key, cached_frame>::iterator it);
+
+            std::list<frame_key>                    m_lru; //most recently used first
+            std::map<frame_key, cached_frame>       m_frames;
+            size_t                                  m_size;
+            size_t                                  m_max_size;
+        };
+    }
+}
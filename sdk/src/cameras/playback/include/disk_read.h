@@ -3,6 +3,7 @@
 
 #pragma once
 #include "disk_read_base.h"
+#include "include/packed_format.h"
 
 namespace rs
 {
@@ -11,13 +12,21 @@ namespace rs
         class disk_read : public disk_read_base
         {
         public:
-            disk_read(const char *file_name) : disk_read_base(file_name) {}
+            disk_read(const char *file_name) : disk_read_base(file_name), m_packed_context() {}
             virtual ~disk_read(void);
         protected:
             virtual rs::core::status read_headers() override;
             virtual void index_next_samples(uint32_t number_of_samples) override;
             virtual int32_t size_of_pitches(void) override;
             virtual uint32_t read_frame_metadata(const std::shared_ptr<core::file_types::frame_sample> & frame, unsigned long num_bytes_to_read) override;
+            core::status read_trailer(int64_t trailer_offset);
+            void read_frame_indexing(const std::vector<uint8_t> &frame_indexing);
+            //frame indexing and samples batch chunks are sequences of records of the sample info followed by the sample type specific info
+            //records of version 4 files are packed and delta coded, the context holds the previous record of the sequence
+            std::shared_ptr<core::file_types::sample> read_index_record(const uint8_t *& it, const uint8_t * end, core::file_types::packed::context & context);
+            bool index_packed_sample(const core::file_types::chunk_info & sample_info_chunk);
+
+            core::file_types::packed::context m_packed_context; //delta coding state of the per sample chunks, in file order
         };
     }
 }
@@ -8,12 +8,20 @@
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <atomic>
+#include <condition_variable>
 #include <chrono>
+#include <future>
+#include <functional>
 #include "compression/decoder.h"
 #include "include/file_types.h"
 #include "status.h"
 #include "disk_read_interface.h"
 #include "include/file.h"
+#include "include/thread_pool.h"
+#include "include/buffer_pool.h"
+#include "sample_index.h"
+#include "decoded_frames_cache.h"
 
 namespace rs
 {
@@ -24,8 +32,15 @@ namespace rs
             struct active_stream_info
             {
                 core::file_types::stream_info   m_stream_info;
-                std::vector<uint32_t>           m_image_indices;
                 uint32_t                        m_prefetched_samples_count;
+                core::buffer_pool               m_frames_buffer_pool; //uncompressed frames which are copied from the file
+                core::buffer_pool               m_encoded_buffer_pool; //compressed frames which are read from the file until they are decoded
+            };
+
+            struct prefetched_sample
+            {
+                std::shared_ptr<core::file_types::sample>                           sample; //the frame descriptor while the frame is decoded
+                std::shared_future<std::shared_ptr<core::file_types::frame_sample>> decoded; //valid while the frame is decoded by the pool
             };
 
         public:
@@ -39,6 +54,10 @@ namespace rs
             virtual bool is_motion_tracking_enabled() override { return m_is_motion_tracking_enabled; }
             virtual void enable_motions_callback(bool state) override;
             virtual void set_realtime(bool realtime) override;
+            virtual void set_decode_lookahead(uint32_t frames_count, uint32_t threads_count) override;
+            virtual void set_index_cache(bool enabled) override;
+            virtual bool set_playback_speed(double speed) override;
+            virtual double query_playback_speed() override;
             virtual std::map<rs_stream, std::shared_ptr<core::file_types::frame_sample>> set_frame_by_index(uint32_t index, rs_stream stream_type) override;
             virtual std::map<rs_stream, std::shared_ptr<core::file_types::frame_sample>> set_frame_by_time_stamp(uint64_t ts) override;
             virtual bool query_realtime() override { return m_realtime; }
@@ -61,6 +80,18 @@ namespace rs
             virtual void index_next_samples(uint32_t number_of_samples) = 0;
             virtual int32_t size_of_pitches(void) = 0;
             virtual std::shared_ptr<core::file_types::frame_sample> read_image_buffer(std::shared_ptr<rs::core::file_types::frame_sample> &frame);
+            //read the frame data and return the decode of the frame, which doesn't access the file and may run on another thread
+            std::function<std::shared_ptr<core::file_types::frame_sample>()> read_image(std::shared_ptr<rs::core::file_types::frame_sample> &frame);
+            //returns the frame from the decoded frames cache, the frame is read and cached if it isn't cached.
+            //called under the lock, which is released while a frame that is still decoded is waited for
+            std::shared_ptr<core::file_types::frame_sample> read_cached_frame(std::unique_lock<std::mutex> & guard, std::shared_ptr<rs::core::file_types::frame_sample> &frame);
+            //reads the stream frames which follow the frame in the direction of travel, and caches them while they are decoded in the background
+            void prefetch_neighbour_frames(rs_stream stream, uint32_t index_in_stream, bool is_forward);
+            uint32_t get_prefetched_frames_count();
+            //the decode pool is enabled and the lookahead window isn't full, called with m_mutex locked
+            bool is_lookahead_available();
+            //frame data that isn't aligned to the pixel word size is copied rather than viewed in place
+            static bool is_aligned(const uint8_t * data, int bpp);
             void read_thread();
             core::file_types::version query_sdk_version();
             core::file_types::version query_librealsense_version();
@@ -72,33 +103,80 @@ namespace rs
             std::map<rs_stream, std::shared_ptr<core::file_types::frame_sample>> find_nearest_frames(uint32_t sample_index, rs_stream stream);
             bool all_samples_bufferd();
             void init_decoder();
+            //bounds the released frame buffers which are kept for reuse by the decode lookahead
+            void set_max_free_frames();
             virtual uint32_t read_frame_metadata(const std::shared_ptr<core::file_types::frame_sample>& frame, unsigned long num_bytes_to_read) = 0;            int64_t calc_sleep_time(std::shared_ptr<core::file_types::sample> sample);
 
 
             playback::capture_mode get_capture_mode();
 
-            static const int                                                NUMBER_OF_SAMPLES_TO_INDEX = 1;
+            //the samples are indexed by the indexing thread, which starts on init if the file index isn't complete.
+            //derived classes stop the indexing on destruction, before the indexing functions are destructed.
+            void indexing_thread();
+            void stop_indexing();
+            //waits under the lock until the samples index satisfies the predicate or is complete, returns the predicate value
+            template<typename predicate>
+            bool wait_for_index(std::unique_lock<std::mutex> & guard, predicate is_indexed)
+            {
+                m_index_cv.wait(guard, [this, &is_indexed]() { return is_indexed() || m_is_index_complete || m_stop_indexing; });
+                return is_indexed();
+            }
+            bool wait_for_next_sample();
+            //waits for the next sample while the lookahead window isn't full, returns false if it is full or the file has no more samples
+            bool wait_for_next_lookahead_sample();
+            //waits until the sample time on the playback clock, returns early on pause. The wait is recalculated when the time base changes.
+            void wait_for_sample_time(const std::shared_ptr<core::file_types::sample> & sample);
+            std::chrono::steady_clock::time_point get_sample_time(const std::shared_ptr<core::file_types::sample> & sample);
+
+            //files without an index are indexed once, the index is kept in a sidecar file which is valid while the file is unchanged
+            bool load_index_cache();
+            void save_index_cache();
+            bool query_file_stat(uint64_t & size, int64_t & modification_time);
+
+            //the indexing thread releases the lock between batches
+            static const int                                                NUMBER_OF_SAMPLES_TO_INDEX = 64;
+
+            static constexpr double                                         MIN_PLAYBACK_SPEED = 0.1;
+            static constexpr double                                         MAX_PLAYBACK_SPEED = 16;
 
             //if IMU and video streams are enabled no more than 4 images will be bufferd per stream
             static const int                                                NUMBER_OF_REQUIRED_PREFETCHED_SAMPLES = 20;
+            static const size_t                                             DECODED_FRAMES_CACHE_SIZE = 256 * 1024 * 1024;
+            static const uint32_t                                           NUMBER_OF_PREFETCHED_NEIGHBOUR_FRAMES = 4;
 
             std::string                                                     m_file_path;
             //file pointers
             std::unique_ptr<core::file>                                     m_file_indexing;//use only for samples indexing
             std::unique_ptr<core::file>                                     m_file_data_read;//use both for file header read and image data read
 
-            bool                                                            m_pause;
-            bool                                                            m_realtime;
-            bool                                                            m_is_index_complete;
+            std::atomic<bool>                                               m_pause;
+            std::atomic<bool>                                               m_realtime;
+            std::atomic<bool>                                               m_is_index_complete;
+            std::atomic<bool>                                               m_stop_indexing;
+            std::thread                                                     m_indexing_thread;
+            std::condition_variable                                         m_index_cv; //notified on indexing progress
+            bool                                                            m_is_index_cache_required; //the index is built from the samples and wasn't loaded from the cache
+            bool                                                            m_is_index_cache_enabled; //the index cache is written when the index is built from the samples
 
             std::mutex                                                      m_mutex;
             std::thread                                                     m_thread;
 
             std::shared_ptr<core::compression::decoder>                     m_decoder;
-            std::vector<uint8_t>                                            m_encoded_data;
-
-            std::chrono::high_resolution_clock::time_point                  m_base_sys_time;
+            uint32_t                                                        m_decode_lookahead; //frames read ahead and decoded by the pool, 0 - frames are decoded on the read thread
+            std::unique_ptr<core::thread_pool>                              m_decode_pool;
+
+            //decoded frames of the seek requests and their neighbours, for frame stepping and scrubbing
+            decoded_frames_cache                                            m_decoded_frames_cache;
+            std::atomic<uint32_t>                                           m_pending_neighbour_frames; //queued to the neighbour frames pool and not decoded yet
+            std::unique_ptr<core::thread_pool>                              m_neighbour_frames_pool; //decodes the neighbour frames, created on the first seek
+            uint32_t                                                        m_last_seek_sample_index;
+
+            //the playback clock - a sample capture time maps to the base system time plus its distance from the base time stamp divided by the speed
+            std::mutex                                                      m_time_base_mutex;
+            std::condition_variable                                         m_time_base_cv; //notified on pause and on time base change
+            std::chrono::steady_clock::time_point                           m_base_sys_time;
             uint64_t                                                        m_base_ts;
+            double                                                          m_playback_speed;
 
             //file static info
             core::file_types::sw_info                                       m_sw_info;
@@ -113,9 +191,8 @@ namespace rs
             bool                                                            m_is_motion_tracking_enabled;
 
             //sticky variables, calculated once in objects lifetime
-            std::map<rs_stream, std::vector<uint32_t>>                      m_image_indices; // index in m_samples_descriptors
-            std::queue<std::shared_ptr<core::file_types::sample>>           m_prefetched_samples;
-            std::vector<std::shared_ptr<core::file_types::sample>>          m_samples_desc; // growing vector of all samples descriptors in order of capture
+            std::queue<prefetched_sample>                                   m_prefetched_samples;
+            sample_index                                                    m_samples_index; // growing index of all samples in order of capture
             uint32_t                                                        m_samples_desc_index; // points to the nexr indexed sample, which wasn't prefetched yet
 
             std::function<void(std::shared_ptr<core::file_types::sample>)>  m_sample_callback;
@@ -37,6 +37,20 @@ namespace rs
                 status = file_->read_bytes(&file_type_id, sizeof(file_type_id), nbytesRead);
                 if (status != rs::core::status_no_error) return status;
 
+                if (file_type_id == UID('R', 'S', 'L', '4'))
+                {
+                    LOG_INFO("create disk read for Linux file format version 4")
+                    disk_read = std::unique_ptr<disk_read_interface>(new playback::disk_read(file_name));
+                    return disk_read->init();
+                }
+
+                if (file_type_id == UID('R', 'S', 'L', '3'))
+                {
+                    LOG_INFO("create disk read for Linux file format version 3")
+                    disk_read = std::unique_ptr<disk_read_interface>(new playback::disk_read(file_name));
+                    return disk_read->init();
+                }
+
                 if (file_type_id == UID('R', 'S', 'L', '2'))
                 {
                     LOG_INFO("create disk read for Linux file format version 2")
@@ -31,6 +31,10 @@ namespace rs
             virtual std::vector<rs_capabilities> get_capabilities() = 0;
             virtual std::map<rs_option, double> get_properties() = 0;
             virtual void set_realtime(bool realtime) = 0;
+            virtual void set_decode_lookahead(uint32_t frames_count, uint32_t threads_count) = 0;
+            virtual void set_index_cache(bool enabled) = 0;
+            virtual bool set_playback_speed(double speed) = 0;
+            virtual double query_playback_speed() = 0;
             virtual std::map<rs_stream, std::shared_ptr<core::file_types::frame_sample>> set_frame_by_index(uint32_t index, rs_stream stream_type) = 0;
             virtual std::map<rs_stream, std::shared_ptr<core::file_types::frame_sample>> set_frame_by_time_stamp(uint64_t ts) = 0;
             virtual bool query_realtime() = 0;
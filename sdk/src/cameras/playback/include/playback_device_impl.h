@@ -128,6 +128,10 @@ namespace rs
             virtual bool                            set_frame_by_index(int index, rs_stream stream) override;
             virtual bool                            set_frame_by_timestamp(uint64_t timestamp) override;
             virtual void                            set_real_time(bool realtime) override;
+            virtual void                            set_decode_lookahead(uint32_t frames_count, uint32_t threads_count) override;
+            virtual void                            set_index_cache(bool enabled) override;
+            virtual bool                            set_playback_speed(double speed) override;
+            virtual double                          get_playback_speed() override;
             virtual int                             get_frame_index(rs_stream stream) override;
             virtual int                             get_frame_count(rs_stream stream) override;
             virtual int                             get_frame_count() override;
@@ -149,6 +153,7 @@ namespace rs
             static const int                                                    LIBREALSENSE_IMU_BUFFER_SIZE = 12;
 
             bool                                                                m_wait_streams_request;
+            std::condition_variable                                             m_wait_streams_request_cv;
             std::condition_variable                                             m_all_stream_available_cv;
             std::mutex                                                          m_all_stream_available_mutex;
             bool                                                                m_is_streaming;
@@ -21,6 +21,10 @@ namespace rs
             virtual bool set_frame_by_index(int index, rs_stream stream) = 0;
             virtual bool set_frame_by_timestamp(uint64_t timestamp) = 0;
             virtual void set_real_time(bool realtime) = 0;
+            virtual void set_decode_lookahead(uint32_t frames_count, uint32_t threads_count) = 0;
+            virtual void set_index_cache(bool enabled) = 0;
+            virtual bool set_playback_speed(double speed) = 0;
+            virtual double get_playback_speed() = 0;
             virtual int get_frame_index(rs_stream stream) = 0;
             virtual int get_frame_count(rs_stream stream) = 0;
             virtual int get_frame_count() = 0;
@@ -0,0 +1,78 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2016 Intel Corporation. All Rights Reserved.
+
+#pragma once
+#include <vector>
+#include <map>
+#include <memory>
+#include <librealsense/rs.hpp>
+#include "include/file_types.h"
+
+namespace rs
+{
+    namespace playback
+    {
+        /**
+        * @class sample_index
+        * @brief Samples index of a playback file, kept as arrays of the per sample values.
+        *
+        * The index holds the values which are required to seek in the file and to read the samples.
+        * Frame values which don't change along a stream, such as resolution and format, are kept once per change.
+        * Sample descriptors are created on access, the index doesn't hold sample objects.
+        */
+        class sample_index
+        {
+        public:
+            //the frame index in stream is assigned by the index
+            void push_back(const std::shared_ptr<core::file_types::sample> & sample);
+            void push_frame(const core::file_types::frame_info & frame_info, const core::file_types::sample_info & sample_info);
+            void push_motion(const rs_motion_data & motion_data, const core::file_types::sample_info & sample_info);
+            void push_time_stamp(const rs_timestamp_data & time_stamp_data, const core::file_types::sample_info & sample_info);
+            void reserve(size_t samples_count);
+
+            size_t size() const { return m_capture_times.size(); }
+            //creates the descriptor of the sample at the index, the descriptor isn't shared with the index
+            std::shared_ptr<core::file_types::sample> at(size_t index) const;
+
+            core::file_types::sample_type type(size_t index) const { return static_cast<core::file_types::sample_type>(m_types[index]); }
+            uint64_t capture_time(size_t index) const { return m_capture_times[index]; }
+            //RS_STREAM_COUNT for samples which are not frames
+            rs_stream stream(size_t index) const { return static_cast<rs_stream>(m_streams[index]); }
+            //the frame time stamp of a frame sample
+            double time_stamp(size_t index) const;
+
+            uint32_t frames_count(rs_stream stream) const;
+            //index of the frame in the samples index
+            uint32_t frame_sample_index(rs_stream stream, uint32_t index_in_stream) const;
+            //the index in stream of the first frame in file order which its time stamp is not less than the time stamp, frames count if there is none
+            uint32_t find_frame_by_time_stamp(rs_stream stream, double time_stamp) const;
+            //the index in stream of the first frame which is not before the sample index, frames count if there is none
+            uint32_t find_frame_by_sample_index(rs_stream stream, size_t sample_index) const;
+
+        private:
+            struct stream_frames
+            {
+                stream_frames() : is_time_stamps_sorted(true) {}
+                std::vector<uint32_t>                                       sample_indices;
+                std::vector<unsigned long long>                             numbers;
+                std::vector<double>                                         time_stamps;
+                std::vector<long long>                                      system_times;
+                //the frame info of the frames from the paired index in stream, until the next change
+                std::vector<std::pair<uint32_t, core::file_types::frame_info>> formats;
+                //time stamps are searched by bisection, unless the stream time stamps were reset along the file
+                bool                                                        is_time_stamps_sorted;
+            };
+
+            void push_sample(const core::file_types::sample_info & sample_info, rs_stream stream, uint32_t ordinal);
+
+            std::vector<uint8_t>                    m_types;
+            std::vector<uint8_t>                    m_streams;
+            std::vector<uint64_t>                   m_capture_times;
+            std::vector<uint64_t>                   m_offsets;
+            std::vector<uint32_t>                   m_ordinals; //index in stream for frames, index in the data vector for motion and time stamp samples
+            std::map<rs_stream, stream_frames>      m_frames;
+            std::vector<rs_motion_data>             m_motion_data;
+            std::vector<rs_timestamp_data>          m_time_stamp_data;
+        };
+    }
+}
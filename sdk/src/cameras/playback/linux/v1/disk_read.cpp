@@ -19,6 +19,7 @@ namespace rs
                 {
                     LOG_FUNC_SCOPE();
                     pause();
+                    stop_indexing();
                 }
 
                 core::status disk_read::read_headers()
@@ -155,9 +156,7 @@ namespace rs
                                     core::file_types::frame_info frame_info;
                                     if(conversions::convert(fi.data, frame_info) != core::status::status_no_error)
                                         throw std::runtime_error("failed to convert frame info");
-                                    frame_info.index_in_stream = static_cast<uint32_t>(m_image_indices[frame_info.stream].size());
-                                    m_image_indices[frame_info.stream].push_back(static_cast<uint32_t>(m_samples_desc.size()));
-                                    m_samples_desc.push_back(std::make_shared<core::file_types::frame_sample>(frame_info, sample_info));
+                                    m_samples_index.push_frame(frame_info, sample_info);
                                     ++index;
                                     LOG_VERBOSE("frame sample indexed, sample time - " << sample_info.capture_time)
                                     break;
@@ -167,7 +166,7 @@ namespace rs
                                     file_types::disk_format::motion_data md = {};
                                     m_file_indexing->read_bytes(&md, static_cast<uint32_t>(std::min((long unsigned)chunk2.size, (unsigned long)sizeof(md))), nbytesRead);
                                     rs_motion_data motion_data = md.data;
-                                    m_samples_desc.push_back(std::make_shared<core::file_types::motion_sample>(motion_data, sample_info));
+                                    m_samples_index.push_motion(motion_data, sample_info);
                                     ++index;
                                     LOG_VERBOSE("motion sample indexed, sample time - " << sample_info.capture_time)
                                     break;
@@ -177,7 +176,7 @@ namespace rs
                                     file_types::disk_format::time_stamp_data tsd = {};
                                     m_file_indexing->read_bytes(&tsd, static_cast<uint32_t>(std::min((long unsigned)chunk2.size, (unsigned long)sizeof(tsd))), nbytesRead);
                                     rs_timestamp_data time_stamp_data = tsd.data;
-                                    m_samples_desc.push_back(std::make_shared<core::file_types::time_stamp_sample>(time_stamp_data, sample_info));
+                                    m_samples_index.push_time_stamp(time_stamp_data, sample_info);
                                     ++index;
                                     LOG_VERBOSE("time stamp sample indexed, sample time - " << sample_info.capture_time)
                                     break;
@@ -295,6 +295,7 @@ namespace rs
                 }
                 m_wait_streams_request = true;
             }
+            m_wait_streams_request_cv.notify_one();
 
             std::unique_lock<std::mutex> guard(m_all_stream_available_mutex);
             if(m_is_streaming)
@@ -453,7 +454,12 @@ namespace rs
         {
             LOG_INFO("pause");
             std::lock_guard<std::mutex> guard(m_pause_resume_mutex);
-            m_is_streaming = false;
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                m_is_streaming = false;
+            }
+            //release the read thread if it waits for a frames request, before joining it
+            m_wait_streams_request_cv.notify_all();
             m_disk_read->pause();
             signal_all();
             join_callbacks_threads();
@@ -504,6 +510,26 @@ namespace rs
             m_disk_read->set_realtime(realtime);
         }
 
+        void rs_device_ex::set_decode_lookahead(uint32_t frames_count, uint32_t threads_count)
+        {
+            m_disk_read->set_decode_lookahead(frames_count, threads_count);
+        }
+
+        void rs_device_ex::set_index_cache(bool enabled)
+        {
+            m_disk_read->set_index_cache(enabled);
+        }
+
+        bool rs_device_ex::set_playback_speed(double speed)
+        {
+            return m_disk_read->set_playback_speed(speed);
+        }
+
+        double rs_device_ex::get_playback_speed()
+        {
+            return m_disk_read->query_playback_speed();
+        }
+
         int rs_device_ex::get_frame_index(rs_stream stream)
         {
             auto frame = m_available_streams[stream]->get_frame();
@@ -571,8 +597,8 @@ namespace rs
             {
                 if(!m_disk_read->query_realtime())//synced reader non realtime mode
                 {
-                    while(!m_wait_streams_request && m_is_streaming)
-                        std::this_thread::sleep_for (std::chrono::milliseconds(5));//TODO:[mk] replace with cv
+                    std::unique_lock<std::mutex> guard(m_mutex);
+                    m_wait_streams_request_cv.wait(guard, [this]() { return m_wait_streams_request || !m_is_streaming; });
                 }
                 if(m_wait_streams_request)
                 {
@@ -828,6 +854,26 @@ namespace rs
             ((rs_device_ex*)this)->set_real_time(realtime);
         }
 
+        void device::set_decode_lookahead(uint32_t frames_count, uint32_t threads_count)
+        {
+            ((rs_device_ex*)this)->set_decode_lookahead(frames_count, threads_count);
+        }
+
+        void device::set_index_cache(bool enabled)
+        {
+            ((rs_device_ex*)this)->set_index_cache(enabled);
+        }
+
+        bool device::set_playback_speed(double speed)
+        {
+            return ((rs_device_ex*)this)->set_playback_speed(speed);
+        }
+
+        double device::get_playback_speed()
+        {
+            return ((rs_device_ex*)this)->get_playback_speed();
+        }
+
         int device::get_frame_index(rs::stream stream)
         {
             return ((rs_device_ex*)this)->get_frame_index((rs_stream)stream);
@@ -0,0 +1,152 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2016 Intel Corporation. All Rights Reserved.
+
+#include "sample_index.h"
+#include <algorithm>
+
+using namespace rs::core;
+using namespace rs::playback;
+
+namespace
+{
+    bool is_same_format(const file_types::frame_info & lhs, const file_types::frame_info & rhs)
+    {
+        return lhs.width == rhs.width && lhs.height == rhs.height && lhs.format == rhs.format && lhs.stride == rhs.stride &&
+               lhs.bpp == rhs.bpp && lhs.framerate == rhs.framerate && lhs.time_stamp_domain == rhs.time_stamp_domain;
+    }
+}
+
+void sample_index::push_back(const std::shared_ptr<file_types::sample> & sample)
+{
+    switch(sample->info.type)
+    {
+        case file_types::sample_type::st_image:
+        {
+            auto frame = std::static_pointer_cast<file_types::frame_sample>(sample);
+            push_frame(frame->finfo, frame->info);
+            break;
+        }
+        case file_types::sample_type::st_motion:
+        {
+            auto motion = std::static_pointer_cast<file_types::motion_sample>(sample);
+            push_motion(motion->data, motion->info);
+            break;
+        }
+        case file_types::sample_type::st_time:
+        {
+            auto time_stamp = std::static_pointer_cast<file_types::time_stamp_sample>(sample);
+            push_time_stamp(time_stamp->data, time_stamp->info);
+            break;
+        }
+    }
+}
+
+void sample_index::push_frame(const file_types::frame_info & frame_info, const file_types::sample_info & sample_info)
+{
+    auto & frames = m_frames[frame_info.stream];
+    auto index_in_stream = static_cast<uint32_t>(frames.sample_indices.size());
+    if(frames.formats.empty() || !is_same_format(frames.formats.back().second, frame_info))
+        frames.formats.push_back(std::make_pair(index_in_stream, frame_info));
+    if(!frames.time_stamps.empty() && frame_info.time_stamp < frames.time_stamps.back())
+        frames.is_time_stamps_sorted = false;
+    frames.sample_indices.push_back(static_cast<uint32_t>(size()));
+    frames.numbers.push_back(frame_info.number);
+    frames.time_stamps.push_back(frame_info.time_stamp);
+    frames.system_times.push_back(frame_info.system_time);
+    push_sample(sample_info, frame_info.stream, index_in_stream);
+}
+
+void sample_index::push_motion(const rs_motion_data & motion_data, const file_types::sample_info & sample_info)
+{
+    push_sample(sample_info, rs_stream::RS_STREAM_COUNT, static_cast<uint32_t>(m_motion_data.size()));
+    m_motion_data.push_back(motion_data);
+}
+
+void sample_index::push_time_stamp(const rs_timestamp_data & time_stamp_data, const file_types::sample_info & sample_info)
+{
+    push_sample(sample_info, rs_stream::RS_STREAM_COUNT, static_cast<uint32_t>(m_time_stamp_data.size()));
+    m_time_stamp_data.push_back(time_stamp_data);
+}
+
+void sample_index::push_sample(const file_types::sample_info & sample_info, rs_stream stream, uint32_t ordinal)
+{
+    m_types.push_back(static_cast<uint8_t>(sample_info.type));
+    m_streams.push_back(static_cast<uint8_t>(stream));
+    m_capture_times.push_back(sample_info.capture_time);
+    m_offsets.push_back(sample_info.offset);
+    m_ordinals.push_back(ordinal);
+}
+
+void sample_index::reserve(size_t samples_count)
+{
+    m_types.reserve(samples_count);
+    m_streams.reserve(samples_count);
+    m_capture_times.reserve(samples_count);
+    m_offsets.reserve(samples_count);
+    m_ordinals.reserve(samples_count);
+}
+
+std::shared_ptr<file_types::sample> sample_index::at(size_t index) const
+{
+    file_types::sample_info info = {};
+    info.type = type(index);
+    info.capture_time = m_capture_times[index];
+    info.offset = m_offsets[index];
+    info.capture_time_unit = file_types::time_unit::microseconds;
+    auto ordinal = m_ordinals[index];
+    switch(info.type)
+    {
+        case file_types::sample_type::st_image:
+        {
+            auto & frames = m_frames.at(stream(index));
+            auto format = std::upper_bound(frames.formats.begin(), frames.formats.end(), ordinal,
+                                           [](uint32_t value, const std::pair<uint32_t, file_types::frame_info> & format) { return value < format.first; });
+            file_types::frame_info frame_info = (format - 1)->second;
+            frame_info.number = frames.numbers[ordinal];
+            frame_info.time_stamp = frames.time_stamps[ordinal];
+            frame_info.system_time = frames.system_times[ordinal];
+            frame_info.index_in_stream = ordinal;
+            return std::make_shared<file_types::frame_sample>(frame_info, info);
+        }
+        case file_types::sample_type::st_motion: return std::make_shared<file_types::motion_sample>(m_motion_data[ordinal], info);
+        case file_types::sample_type::st_time: return std::make_shared<file_types::time_stamp_sample>(m_time_stamp_data[ordinal], info);
+        default: return nullptr;
+    }
+}
+
+double sample_index::time_stamp(size_t index) const
+{
+    return m_frames.at(stream(index)).time_stamps[m_ordinals[index]];
+}
+
+uint32_t sample_index::frames_count(rs_stream stream) const
+{
+    auto frames = m_frames.find(stream);
+    return frames == m_frames.end() ? 0 : static_cast<uint32_t>(frames->second.sample_indices.size());
+}
+
+uint32_t sample_index::frame_sample_index(rs_stream stream, uint32_t index_in_stream) const
+{
+    return m_frames.at(stream).sample_indices[index_in_stream];
+}
+
+uint32_t sample_index::find_frame_by_time_stamp(rs_stream stream, double time_stamp) const
+{
+    auto frames = m_frames.find(stream);
+    if(frames == m_frames.end()) return 0;
+    auto & time_stamps = frames->second.time_stamps;
+    auto it = frames->second.is_time_stamps_sorted ?
+              std::lower_bound(time_stamps.begin(), time_stamps.end(), time_stamp) :
+              std::find_if(time_stamps.begin(), time_stamps.end(), [time_stamp](double value) { return value >= time_stamp; });
+    return static_cast<uint32_t>(it - time_stamps.begin());
+}
+
+uint32_t sample_index::find_frame_by_sample_index(rs_stream stream, size_t sample_index) const
+{
+    auto frames = m_frames.find(stream);
+    if(frames == m_frames.end()) return 0;
+    auto & sample_indices = frames->second.sample_indices;
+    auto it = std::lower_bound(sample_indices.begin(), sample_indices.end(), sample_index,
+                               [](uint32_t value, size_t sample_index) { return value < sample_index; });
+    return static_cast<uint32_t>(it - sample_indices.begin());
+}
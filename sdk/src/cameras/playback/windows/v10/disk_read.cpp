@@ -46,6 +46,7 @@ namespace rs
                 {
                     LOG_FUNC_SCOPE();
                     pause();
+                    stop_indexing();
                 }
 
                 void disk_read::handle_ds_projection(std::vector<uint8_t> &projection_data)
@@ -216,9 +217,7 @@ namespace rs
                             sample_info.type = core::file_types::sample_type::st_image;
                             sample_info.capture_time = static_cast<uint64_t>(frame_info.time_stamp);
                             m_file_indexing->get_position(&sample_info.offset);
-                            frame_info.index_in_stream = static_cast<uint32_t>(m_image_indices[frame_info.stream].size());
-                            m_image_indices[frame_info.stream].push_back(static_cast<uint32_t>(m_samples_desc.size()));
-                            m_samples_desc.push_back(std::make_shared<core::file_types::frame_sample>(frame_info, sample_info));
+                            m_samples_index.push_frame(frame_info, sample_info);
                             ++index;
                             LOG_VERBOSE("frame sample indexed, sample time - " << sample_info.capture_time)
                         }
@@ -3,9 +3,13 @@
 
 #include <stddef.h>
 #include <assert.h>
+#include <stdio.h>
+#include <string.h>
 #include <tuple>
+#include <algorithm>
 #include "disk_write.h"
 #include "include/file.h"
+#include "include/buffered_file.h"
 #include "rs_sdk_version.h"
 #include "rs/utils/log_utils.h"
 
@@ -15,13 +19,41 @@ namespace rs
 {
     namespace record
     {
-        static const uint32_t MAX_MEMORY_CONSUMPTION_PER_STREAM = 100e6;
+        static const uint64_t MAX_MEMORY_CONSUMPTION_PER_STREAM = 100e6;
+        static const std::chrono::milliseconds COMPRESSION_ADAPTATION_INTERVAL(100);
+        static const double HIGH_QUEUE_FILL = 0.25;
+        static const double LOW_QUEUE_FILL = 0.05;
+        static const double HIGH_ENCODE_LOAD = 0.8;
+        static const double LOW_ENCODE_LOAD = 0.4;
+        static const size_t MAX_SAMPLES_PER_BATCH = 256;
+        //the memory budget bounds the queued frames, the capacity covers motion samples bursts while the queues are not drained
+        static const size_t SOURCE_QUEUE_CAPACITY = 4096;
 
         disk_write::disk_write(void):
             m_is_configured(false),
             m_paused(false),
             m_stop_writing(true),
-            m_min_fps(0)
+            m_encoder_threads_count(1),
+            m_min_fps(0),
+            m_memory_budget(0),
+            m_back_pressure_policy(back_pressure_policy::drop_newest),
+            m_queued_bytes(0),
+            m_peak_queued_bytes(0),
+            m_dropped_samples(0),
+            m_dropped_bytes(0),
+            m_waiting_threads_count(0),
+            m_acceleration(1),
+            m_encode_time(0),
+            m_adaptive_frames_rate(0),
+            m_segment_index(0),
+            m_segment_start_time(0),
+            m_last_capture_time(0),
+            m_is_segment_empty(true),
+            m_ring_bytes(0),
+            m_is_trigger_pending(false),
+            m_trigger_start_time(0),
+            m_trigger_end_time(0),
+            m_last_queued_capture_time(0)
         {
 
         }
@@ -46,19 +78,110 @@ namespace rs
             return rv;
         }
 
-        bool disk_write::allow_sample(std::shared_ptr<rs::core::file_types::sample> &sample)
+        uint64_t disk_write::get_sample_size(const std::shared_ptr<file_types::sample> &sample)
         {
-            if(sample->info.type != file_types::sample_type::st_image) return true;
-            auto frame = std::dynamic_pointer_cast<file_types::frame_sample>(sample);
-            if (frame)
+            switch(sample->info.type)
             {
-                auto size = (double)(frame->finfo.stride * frame->finfo.height);
-                auto max_samples = (double)(MAX_MEMORY_CONSUMPTION_PER_STREAM) / (double)size * frame->finfo.framerate / m_min_fps;
-                if(m_samples_count[frame->finfo.stream] > max_samples) return false;
-                m_samples_count[frame->finfo.stream]++;
-                return true;
+                case file_types::sample_type::st_image:
+                {
+                    auto frame = std::dynamic_pointer_cast<file_types::frame_sample>(sample);
+                    if(!frame) return sizeof(file_types::frame_sample);
+                    return sizeof(file_types::frame_sample) + static_cast<uint64_t>(frame->finfo.stride * frame->finfo.height) +
+                            frame->metadata.size() * sizeof(std::pair<rs_frame_metadata, double>);
+                }
+                case file_types::sample_type::st_motion: return sizeof(file_types::motion_sample);
+                case file_types::sample_type::st_time: return sizeof(file_types::time_stamp_sample);
+                default: return sizeof(file_types::sample);
+            }
+        }
+
+        bool disk_write::is_memory_available(uint64_t size)
+        {
+            //a sample is always accepted when no memory is in use, even if it exceeds the budget by itself
+            auto queued_bytes = m_queued_bytes.load();
+            return queued_bytes + size <= m_memory_budget || queued_bytes == 0;
+        }
+
+        bool disk_write::try_reserve_memory(uint64_t size)
+        {
+            auto queued_bytes = m_queued_bytes.load();
+            do
+            {
+                if(queued_bytes + size > m_memory_budget && queued_bytes != 0) return false;
+            }
+            while(!m_queued_bytes.compare_exchange_weak(queued_bytes, queued_bytes + size));
+
+            auto peak_queued_bytes = m_peak_queued_bytes.load();
+            while(queued_bytes + size > peak_queued_bytes && !m_peak_queued_bytes.compare_exchange_weak(peak_queued_bytes, queued_bytes + size));
+            return true;
+        }
+
+        bool disk_write::reserve_memory(std::unique_lock<std::mutex> &guard, uint64_t size)
+        {
+            while(!try_reserve_memory(size))
+            {
+                switch(m_back_pressure_policy)
+                {
+                    case back_pressure_policy::drop_oldest:
+                    {
+                        //samples that are being encoded or written can't be dropped, if they still exceed the budget the new sample is dropped
+                        auto oldest = std::find_if(m_samples_queue.begin(), m_samples_queue.end(),
+                                                   [](const std::shared_ptr<sample_to_write> & item) { return !item->is_encoding; });
+                        if(oldest == m_samples_queue.end()) return false;
+                        auto item = *oldest;
+                        m_samples_queue.erase(oldest);
+                        item->is_dropped = true;//the encoder threads skip dropped samples
+                        drop_sample(item->sample, item->size);
+                        m_queued_bytes -= item->size;
+                        auto counters = get_stream_counters(item->sample);
+                        if(counters) counters->queued_frames--;
+                        break;
+                    }
+                    case back_pressure_policy::block:
+                        if(m_stop_writing) return false;
+                        m_notify_producer_cv.wait(guard, [this, size]() { return m_stop_writing || is_memory_available(size); });
+                        break;
+                    case back_pressure_policy::drop_newest:
+                    default:
+                        return false;
+                }
+            }
+            return true;
+        }
+
+        void disk_write::drop_sample(const std::shared_ptr<file_types::sample> &sample, uint64_t size)
+        {
+            m_dropped_samples++;
+            m_dropped_bytes += size;
+            auto counters = get_stream_counters(sample);
+            if(counters) counters->frames_dropped++;
+            LOG_WARN("sample drop, sample type - " << sample->info.type << " ,capture time - " << sample->info.capture_time);
+        }
+
+        disk_write::sample_queue * disk_write::get_source_queue(const std::shared_ptr<file_types::sample> &sample)
+        {
+            switch(sample->info.type)
+            {
+                case file_types::sample_type::st_image:
+                {
+                    auto frame = std::dynamic_pointer_cast<file_types::frame_sample>(sample);
+                    if(!frame) return nullptr;
+                    auto queue = m_frame_queues.find(frame->finfo.stream);
+                    return queue != m_frame_queues.end() ? queue->second.get() : nullptr;
+                }
+                case file_types::sample_type::st_motion: return m_motion_queue.get();
+                case file_types::sample_type::st_time: return m_time_stamp_queue.get();
+                default: return nullptr;
             }
-            return false;
+        }
+
+        stream_counters * disk_write::get_stream_counters(const std::shared_ptr<file_types::sample> &sample)
+        {
+            if(sample->info.type != file_types::sample_type::st_image) return nullptr;
+            auto frame = std::dynamic_pointer_cast<file_types::frame_sample>(sample);
+            if(!frame) return nullptr;
+            auto counters = m_stream_counters.find(frame->finfo.stream);
+            return counters != m_stream_counters.end() ? counters->second.get() : nullptr;
         }
 
         void disk_write::record_sample(std::shared_ptr<file_types::sample> &sample)
@@ -68,24 +191,185 @@ namespace rs
             {
                 return;//device is still streaming but samples are not recorded
             }
-            bool insert_samples = false;
+            if(m_stop_writing)
+            {
+                return;//samples that are queued while stopping are released by stop
+            }
+            auto size = get_sample_size(sample);
+            auto item = std::make_shared<sample_to_write>();
+            item->sample = sample;
+            item->size = size;
+            item->encoded_data_size = 0;
+            item->encode_status = status::status_no_error;
+            item->is_encoded = false;
+            item->is_ready = true;
+            item->is_encoding = false;
+            item->is_dropped = false;
+            item->queued_time = std::chrono::steady_clock::now();
+            auto counters = get_stream_counters(sample);
+            if(counters) counters->frames_received++;
+
+            //each source is pushed by a single callback thread, the sample is queued without locking while it fits the memory budget
+            auto queue = get_source_queue(sample);
+            if(queue && try_reserve_memory(size))
+            {
+                if(counters) counters->queued_frames++;
+                if(queue->try_push(std::move(item)))
+                {
+                    m_last_queued_capture_time = sample->info.capture_time;
+                    notify_waiting_threads();
+                    return;
+                }
+                m_queued_bytes -= size;
+                if(counters) counters->queued_frames--;
+            }
+            if(queue && m_back_pressure_policy == back_pressure_policy::drop_newest)
+            {
+                drop_sample(sample, size);
+                return;
+            }
+
+            //the budget or the source queue is full, the back pressure policy requires the queued samples
+            std::unique_lock<std::mutex> guard(m_main_mutex);
+            dispatch_samples();
+            if(!reserve_memory(guard, size))
+            {
+                drop_sample(sample, size);
+                return;
+            }
+            //the source queue was drained, queuing directly keeps the capture order
+            m_last_queued_capture_time = sample->info.capture_time;
+            if(counters) counters->queued_frames++;
+            if(queue_sample(item))
+                m_notify_encoder_threads_cv.notify_one();
+            //notify also on encoded samples, dropping the oldest samples may expose a ready sample to the write thread
+            m_notify_write_thread_cv.notify_one();
+        }
+
+        void disk_write::notify_waiting_threads()
+        {
+            //pairs with the fence of wait_for_samples, either the waiting thread sees the new sample or the waiting threads count is seen here
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if(m_waiting_threads_count.load(std::memory_order_relaxed) == 0) return;
+            //the mutex is taken only when a consumer waits. the consumer holds it from its condition check until it waits,
+            //so the notification isn't sent in between and lost
             {
                 std::lock_guard<std::mutex> guard(m_main_mutex);
-                insert_samples = allow_sample(sample);
-                if (insert_samples)//it is ok that sample queue size may exceed MAX_CACHED_SAMPLES by few samples
+            }
+            m_notify_write_thread_cv.notify_one();
+            m_notify_encoder_threads_cv.notify_one();
+        }
+
+        bool disk_write::queue_sample(const std::shared_ptr<sample_to_write> &item)
+        {
+            bool encode = false;
+            if(item->sample->info.type == file_types::sample_type::st_image)
+            {
+                auto frame = std::dynamic_pointer_cast<file_types::frame_sample>(item->sample);
+                encode = frame && m_encoder->get_compression_type(frame->finfo.stream) != file_types::compression_type::none;
+            }
+            if(encode)
+            {
+                item->is_ready = false;
+                m_encode_queue.push(item);
+            }
+            m_samples_queue.push_back(item);
+            return encode;
+        }
+
+        void disk_write::dispatch_samples()
+        {
+            //samples recorded after stop are kept in the source queues until they are released, the threads don't wait for them
+            if(m_stop_writing) return;
+            bool is_dispatched = false;
+            bool encode = false;
+            for(;;)
+            {
+                //the source queues are merged in capture order
+                sample_queue * oldest_queue = nullptr;
+                uint64_t oldest_capture_time = 0;
+                for(auto queue : m_source_queues)
                 {
-                    m_samples_queue.push(sample);
+                    auto item = queue->front();
+                    if(item && (!oldest_queue || (*item)->sample->info.capture_time < oldest_capture_time))
+                    {
+                        oldest_queue = queue;
+                        oldest_capture_time = (*item)->sample->info.capture_time;
+                    }
                 }
-                else
+                if(!oldest_queue) break;
+                encode |= queue_sample(*oldest_queue->front());
+                oldest_queue->pop();
+                is_dispatched = true;
+            }
+            if(encode)
+                m_notify_encoder_threads_cv.notify_all();
+            if(is_dispatched)
+                m_notify_write_thread_cv.notify_one();
+        }
+
+        void disk_write::release_source_queues()
+        {
+            for(auto queue : m_source_queues)
+            {
+                while(auto item = queue->front())
                 {
-                    LOG_WARN("sample drop, sample type - " << sample->info.type << " ,capture time - " << sample->info.capture_time);
+                    auto sample = (*item)->sample;
+                    auto size = (*item)->size;
+                    queue->pop();
+                    m_queued_bytes -= size;
+                    auto counters = get_stream_counters(sample);
+                    if(counters) counters->queued_frames--;
+                    drop_sample(sample, size);
                 }
             }
-            if(insert_samples)
+        }
+
+        template<typename predicate>
+        void disk_write::wait_for_samples(std::unique_lock<std::mutex> &guard, std::condition_variable &cv, predicate is_ready)
+        {
+            m_waiting_threads_count++;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            //the source queues are drained each time the condition is checked, by the write thread or by any of the encoder threads
+            for(;;)
             {
-                std::lock_guard<std::mutex> guard(m_notify_write_thread_mutex);
-                m_notify_write_thread_cv.notify_one();
+                dispatch_samples();
+                if(is_ready()) break;
+                cv.wait(guard);
             }
+            m_waiting_threads_count--;
+        }
+
+        queue_status disk_write::get_queue_status()
+        {
+            queue_status status = {};
+            status.queued_bytes = m_queued_bytes;
+            status.peak_queued_bytes = m_peak_queued_bytes;
+            status.dropped_samples = m_dropped_samples;
+            status.dropped_bytes = m_dropped_bytes;
+            status.ring_bytes = m_ring_bytes;
+            return status;
+        }
+
+        stream_statistics disk_write::get_stream_statistics(rs_stream stream)
+        {
+            stream_statistics statistics = {};
+            auto stream_counters = m_stream_counters.find(stream);
+            if(stream_counters == m_stream_counters.end()) return statistics;
+            auto & counters = *stream_counters->second;
+            statistics.frames_received = counters.frames_received;
+            statistics.frames_written = counters.frames_written;
+            statistics.frames_dropped = counters.frames_dropped;
+            statistics.bytes_in = counters.bytes_in;
+            statistics.bytes_out = counters.bytes_out;
+            statistics.queued_frames = counters.queued_frames;
+            if(statistics.frames_written > 0)
+                statistics.average_latency = static_cast<double>(counters.total_latency) / static_cast<double>(statistics.frames_written) / 1000;
+            statistics.max_latency = static_cast<double>(counters.max_latency) / 1000;
+            statistics.encode_time_p50 = m_encoder->get_encode_time_percentile(stream, 0.5);
+            statistics.encode_time_p90 = m_encoder->get_encode_time_percentile(stream, 0.9);
+            statistics.encode_time_p99 = m_encoder->get_encode_time_percentile(stream, 0.99);
+            return statistics;
         }
 
         bool disk_write::start()
@@ -93,7 +377,10 @@ namespace rs
             LOG_FUNC_SCOPE();
             if(!m_is_configured) return false;
             m_stop_writing = false;//protection is not required before the thread is started
+            release_source_queues();
             assert(!m_thread.joinable());//we don't expect the thread to be active on start
+            for(uint32_t i = 0; i < m_encoder_threads_count; i++)
+                m_encoder_threads.push_back(std::thread(&disk_write::encode_thread, this));
             m_thread = std::thread(&disk_write::write_thread, this);
             return true;
         }
@@ -103,19 +390,34 @@ namespace rs
             LOG_FUNC_SCOPE();
 
             std::unique_lock<std::mutex> guard(m_main_mutex);
+            //the samples that were recorded before stop are dispatched while the encoder threads are still running
+            dispatch_samples();
             m_stop_writing = true;
             guard.unlock();
 
+            //samples that were queued before stop are encoded and written before the threads exit
+            m_notify_producer_cv.notify_all();
+            m_notify_encoder_threads_cv.notify_all();
             m_notify_write_thread_cv.notify_one();
 
+            for(auto & thread : m_encoder_threads)
+            {
+                if (thread.joinable())
+                    thread.join();
+            }
+            m_encoder_threads.clear();
+
             if (m_thread.joinable())
             {
                 m_thread.join();
             }
 
             guard.lock();
-            if(m_file)
-                m_file->close();
+            release_source_queues();
+            close_segment();
+            m_ring.clear();
+            m_ring_bytes = 0;
+            m_is_trigger_pending = false;
             guard.unlock();
         }
 
@@ -129,48 +431,155 @@ namespace rs
         {
             std::lock_guard<std::mutex> guard(m_main_mutex);
             if(m_is_configured) return status::status_exec_aborted;
+            m_config = config;
+            m_segment_index = 0;
+            init_encoder(config);
+            m_encoder_threads_count = get_encoder_threads_count(config);
+            m_min_fps = get_min_fps(config.m_stream_profiles);
+            m_adaptive_frames_rate = 0;
+            for(auto & profile : config.m_stream_profiles)
+            {
+                if(m_encoder->is_adaptive(profile.first))
+                    m_adaptive_frames_rate += static_cast<uint32_t>(profile.second.info.framerate);
+            }
+            m_acceleration = 1;
+            m_encode_time = 0;
+            m_last_adaptation = std::chrono::steady_clock::now();
+            m_memory_budget = config.m_memory_budget > 0 ? config.m_memory_budget :
+                              MAX_MEMORY_CONSUMPTION_PER_STREAM * config.m_stream_profiles.size();
+            m_back_pressure_policy = config.m_back_pressure_policy;
+            m_queued_bytes = 0;
+            m_peak_queued_bytes = 0;
+            m_dropped_samples = 0;
+            m_dropped_bytes = 0;
+            m_frame_queues.clear();
+            m_source_queues.clear();
+            for(auto & profile : config.m_stream_profiles)
+            {
+                m_frame_queues[profile.first] = std::unique_ptr<sample_queue>(new sample_queue(SOURCE_QUEUE_CAPACITY));
+                m_source_queues.push_back(m_frame_queues[profile.first].get());
+            }
+            m_motion_queue.reset(new sample_queue(SOURCE_QUEUE_CAPACITY));
+            m_time_stamp_queue.reset(new sample_queue(SOURCE_QUEUE_CAPACITY));
+            m_source_queues.push_back(m_motion_queue.get());
+            m_source_queues.push_back(m_time_stamp_queue.get());
+            m_stream_counters.clear();
+            for(auto & profile : config.m_stream_profiles)
+            {
+                auto & counters = m_stream_counters[profile.first];
+                counters.reset(new stream_counters());
+                counters->frames_received = 0;
+                counters->frames_written = 0;
+                counters->frames_dropped = 0;
+                counters->bytes_in = 0;
+                counters->bytes_out = 0;
+                counters->queued_frames = 0;
+                counters->total_latency = 0;
+                counters->max_latency = 0;
+            }
+            //with a ring buffer the file is opened only when the ring is dumped
+            if(config.m_ring_duration == 0)
+                open_segment();
+            m_is_configured = true;
+            return status::status_no_error;
+        }
+
+        std::string disk_write::get_segment_path(const std::string &file_path, uint32_t segment_index)
+        {
+            //the segment index is added before the file extension, name.rssdk is recorded to name_00000.rssdk, name_00001.rssdk...
+            auto name_pos = file_path.find_last_of("/\\");
+            auto extension_pos = file_path.find_last_of('.');
+            if(extension_pos == std::string::npos || (name_pos != std::string::npos && extension_pos < name_pos))
+                extension_pos = file_path.size();
+            char index[16] = {};
+            snprintf(index, sizeof(index), "_%05u", segment_index);
+            return file_path.substr(0, extension_pos) + index + file_path.substr(extension_pos);
+        }
+
+        void disk_write::open_segment()
+        {
+            bool is_segmented = m_config.m_segment_size > 0 || m_config.m_segment_duration > 0 || m_config.m_ring_duration > 0;
+            auto file_path = is_segmented ? get_segment_path(m_config.m_file_path, m_segment_index) : m_config.m_file_path;
+#ifdef __linux__
+            m_file = std::unique_ptr<rs::core::file>(new rs::core::buffered_file(rs::core::buffered_file::DEFAULT_BUFFER_SIZE,
+                                                                                  m_config.m_direct_io, m_config.m_file_preallocation_size));
+#else
             m_file = std::unique_ptr<rs::core::file>(new rs::core::file());
-            status sts = m_file->open(config.m_file_path, (open_file_option)(open_file_option::write));
+#endif
+            status sts = m_file->open(file_path, (open_file_option)(open_file_option::write));
 
             if (sts != status::status_no_error)
-                throw std::runtime_error("failed to open file for recording, file path - " + config.m_file_path);
+                throw std::runtime_error("failed to open file for recording, file path - " + file_path);
 
-            init_encoder(config);
-            m_min_fps = get_min_fps(config.m_stream_profiles);
-            write_header(static_cast<uint8_t>(config.m_stream_profiles.size()), config.m_coordinate_system, config.m_capture_mode);
-            write_camera_info(config.m_camera_info);
+            //each segment is a self contained file
+            write_header(static_cast<uint8_t>(m_config.m_stream_profiles.size()), m_config.m_coordinate_system, m_config.m_capture_mode);
+            write_camera_info(m_config.m_camera_info);
             write_sw_info();
-            write_capabilities(config.m_capabilities);
-            write_motion_intrinsics(config.m_motion_intrinsics);
-            write_stream_info(config.m_stream_profiles);
-            write_properties(config.m_options);
+            write_capabilities(m_config.m_capabilities);
+            write_motion_intrinsics(m_config.m_motion_intrinsics);
+            write_stream_info(m_config.m_stream_profiles);
+            write_properties(m_config.m_options);
             write_first_frame_offset();
-            m_is_configured = true;
-            return sts;
+            m_segment_start_time = 0;
+            m_file_context = {};
+            m_index_context = {};
+            m_is_segment_empty = true;
+            LOG_INFO("recording to file - " << file_path.c_str())
+        }
+
+        void disk_write::close_segment()
+        {
+            if(!m_file) return;
+            write_samples_batch();
+            write_trailer();
+            m_file->close();
+            m_file.reset();
+            m_frame_indexing.clear();
+            m_number_of_frames.clear();
+        }
+
+        bool disk_write::is_segment_full(const std::shared_ptr<file_types::sample> &sample)
+        {
+            if(m_is_segment_empty || m_config.m_ring_duration > 0) return false;
+            //samples with the same capture time, as the frames of a synced frameset, are kept in the same segment
+            if(sample->info.capture_time <= m_last_capture_time) return false;
+            if(m_config.m_segment_duration > 0 && sample->info.capture_time - m_segment_start_time >= m_config.m_segment_duration)
+                return true;
+            uint64_t size = 0;
+            m_file->get_position(&size);
+            return m_config.m_segment_size > 0 && size >= m_config.m_segment_size;
+        }
+
+        uint32_t disk_write::get_encoder_threads_count(const configuration& config)
+        {
+            if(config.m_encoder_threads_count > 0)
+                return config.m_encoder_threads_count;
+            uint32_t hardware_threads = std::thread::hardware_concurrency();
+            uint32_t streams_count = static_cast<uint32_t>(config.m_stream_profiles.size());
+            if(hardware_threads == 0 || hardware_threads > streams_count)
+                hardware_threads = streams_count;
+            return hardware_threads > 0 ? hardware_threads : 1;
         }
 
         void disk_write::init_encoder(const configuration& config)
         {
-            uint32_t buffer_size = 0;
             m_encoder.reset(new compression::encoder());
             for(auto profile : config.m_stream_profiles)
             {
                 rs_stream stream = profile.second.info.stream;
                 rs_format format = profile.second.info.format;
-                uint32_t size = profile.second.info.width * profile.second.info.height;
-                buffer_size = size > buffer_size ? size : buffer_size;
+                bool is_lossy = config.m_lossy_compression_streams.find(profile.first) != config.m_lossy_compression_streams.end();
                 if(config.m_compression_config.find(profile.first) != (config.m_compression_config.end()))
                 {
                     auto compression_level = config.m_compression_config.at(profile.first);
                     if(compression_level != record::compression_level::disabled)
-                        m_encoder->add_codec(stream, format, compression_level);
+                        m_encoder->add_codec(stream, format, compression_level, is_lossy, config.m_compression_stripes_count);
                 }
                 else
                 {
-                    m_encoder->add_codec(stream, format, record::compression_level::high);
+                    m_encoder->add_codec(stream, format, record::compression_level::high, is_lossy, config.m_compression_stripes_count);
                 }
             }
-            m_encoded_data = std::vector<uint8_t>(buffer_size * 4);//stride is not available, taking worst case.
         }
 
         void disk_write::write_to_file(const void* data, unsigned int numberOfBytesToWrite, unsigned int& numberOfBytesWritten)
@@ -184,37 +593,251 @@ namespace rs
             }
         }
 
-        void disk_write::write_thread(void)
+        void disk_write::encode_thread(void)
         {
             LOG_FUNC_SCOPE();
-            while (!m_stop_writing)
+            for(;;)
             {
-                std::unique_lock<std::mutex> guard(m_notify_write_thread_mutex);
-                m_notify_write_thread_cv.wait(guard);
-                guard.unlock();
+                std::shared_ptr<sample_to_write> item = nullptr;
+                {
+                    std::unique_lock<std::mutex> guard(m_main_mutex);
+                    wait_for_samples(guard, m_notify_encoder_threads_cv, [this]() { return m_stop_writing || !m_encode_queue.empty(); });
+                    if(m_encode_queue.empty()) break;//stop was requested and all queued frames were encoded
+                    item = m_encode_queue.front();
+                    m_encode_queue.pop();
+                    if(item->is_dropped) continue;
+                    item->is_encoding = true;
+                }
+                auto encode_start = std::chrono::steady_clock::now();
+                encode_sample(item);
+                std::chrono::duration<double> encode_time = std::chrono::steady_clock::now() - encode_start;
+                //only the frames of adaptive streams are affected by the acceleration, other streams don't drive it
+                auto frame = std::dynamic_pointer_cast<file_types::frame_sample>(item->sample);
+                bool is_adaptive = item->is_encoded && frame && m_encoder->is_adaptive(frame->finfo.stream);
+                {
+                    std::lock_guard<std::mutex> guard(m_main_mutex);
+                    item->is_ready = true;
+                    item->is_encoding = false;
+                    if(is_adaptive)
+                        adapt_compression(encode_time.count());
+                }
+                m_notify_write_thread_cv.notify_one();
+            }
+        }
 
-                LOG_VERBOSE("queue contains " << m_samples_queue.size() << " samples")
+        void disk_write::adapt_compression(double encode_time)
+        {
+            //called by the encoder threads with m_main_mutex locked
+            m_encode_time = m_encode_time > 0 ? 0.9 * m_encode_time + 0.1 * encode_time : encode_time;
+            auto now = std::chrono::steady_clock::now();
+            if(now - m_last_adaptation < COMPRESSION_ADAPTATION_INTERVAL) return;
+            m_last_adaptation = now;
+
+            //the share of the encoder threads time required to keep up with the captured frames of the adaptive streams
+            double encode_load = m_encode_time * m_adaptive_frames_rate / m_encoder_threads_count;
+            double queue_fill = static_cast<double>(m_queued_bytes.load()) / static_cast<double>(m_memory_budget);
+            int acceleration = m_acceleration;
+            if(queue_fill > HIGH_QUEUE_FILL || encode_load > HIGH_ENCODE_LOAD)
+            {
+                int max_acceleration = compression::encoder::get_max_acceleration();
+                acceleration = m_acceleration * 2 < max_acceleration ? m_acceleration * 2 : max_acceleration;
+            }
+            else if(queue_fill < LOW_QUEUE_FILL && encode_load < LOW_ENCODE_LOAD)
+            {
+                acceleration = m_acceleration / 2 > 1 ? m_acceleration / 2 : 1;
+            }
+            if(acceleration == m_acceleration) return;
+            LOG_VERBOSE("compression acceleration changed from " << m_acceleration << " to " << acceleration <<
+                        ", queue fill " << queue_fill << ", encode load " << encode_load)
+            m_acceleration = acceleration;
+            m_encoder->set_acceleration(acceleration);
+        }
 
-                std::shared_ptr<core::file_types::sample> sample = nullptr;
-                while(!m_samples_queue.empty())
+        void disk_write::encode_sample(std::shared_ptr<sample_to_write> &item)
+        {
+            auto frame = std::dynamic_pointer_cast<file_types::frame_sample>(item->sample);
+            if(!frame) return;
+            item->encoded_data.resize(m_encoder->get_max_encoded_size(frame->finfo));
+            item->encode_status = m_encoder->encode_frame(frame->finfo, frame->data, item->encoded_data.data(), item->encoded_data_size);
+            item->is_encoded = true;
+        }
+
+        void disk_write::write_thread(void)
+        {
+            LOG_FUNC_SCOPE();
+            for(;;)
+            {
+                std::shared_ptr<sample_to_write> item = nullptr;
+                bool is_triggered = false;
                 {
+                    std::unique_lock<std::mutex> guard(m_main_mutex);
+                    //samples are written in capture order, wait for the oldest sample to be encoded
+                    wait_for_samples(guard, m_notify_write_thread_cv, [this]()
+                    {
+                        return (!m_samples_queue.empty() && m_samples_queue.front()->is_ready) || (m_stop_writing && m_samples_queue.empty()) ||
+                               (m_is_trigger_pending && !m_file);
+                    });
+                    is_triggered = m_is_trigger_pending;
+                    if(m_samples_queue.empty() && !(is_triggered && !m_file)) break;
+                    if(!m_samples_queue.empty() && m_samples_queue.front()->is_ready)
                     {
-                        std::lock_guard<std::mutex> guard(m_main_mutex);
-                        if(m_samples_queue.empty()) break;
-                        sample = m_samples_queue.front();
-                        m_samples_queue.pop();
-                        if(!sample) continue;
+                        LOG_VERBOSE("queue contains " << m_samples_queue.size() << " samples")
+                        item = m_samples_queue.front();
+                        m_samples_queue.pop_front();
+                        auto counters = get_stream_counters(item->sample);
+                        if(counters) counters->queued_frames--;
                     }
-                    write_sample_info(sample);
-                    write_sample(sample);
                 }
+                if(!item && !is_triggered) continue;
+                uint64_t size = item ? item->size : 0;
+                if(m_config.m_ring_duration > 0)
+                    write_to_ring(item, is_triggered);
+                else
+                    write_to_segment(item);
+                if(!item) continue;
+                {
+                    std::lock_guard<std::mutex> guard(m_main_mutex);
+                    m_queued_bytes -= size;
+                }
+                m_notify_producer_cv.notify_all();
+            }
+        }
+
+        void disk_write::write_to_segment(std::shared_ptr<sample_to_write> &item)
+        {
+            if(!item) return;
+            if(is_segment_full(item->sample))
+            {
+                //samples keep being queued while the segments are switched, no sample is dropped at the boundary
+                close_segment();
+                m_segment_index++;
+                open_segment();
+            }
+            if(m_is_segment_empty)
+            {
+                m_segment_start_time = item->sample->info.capture_time;
+                m_is_segment_empty = false;
+            }
+            m_last_capture_time = item->sample->info.capture_time;
+            if(item->sample->info.type != file_types::sample_type::st_image)
+            {
+                m_samples_batch.push_back(item->sample);
+                if(m_samples_batch.size() >= MAX_SAMPLES_PER_BATCH)
+                    write_samples_batch();
+                return;
+            }
+            //batched samples were captured before the image, the batch is written first to keep the capture order
+            write_samples_batch();
+            write_sample_info(item->sample);
+            write_sample(item);
+            add_to_frame_indexing(item->sample);
+        }
+
+        void disk_write::write_to_ring(std::shared_ptr<sample_to_write> &item, bool is_triggered)
+        {
+            if(is_triggered && !m_file)
+            {
+                //dump the samples that preceded the trigger, the following samples are written until the trigger end time
+                open_segment();
+                for(auto & ring_item : m_ring)
+                    if(ring_item->sample->info.capture_time >= m_trigger_start_time)
+                        write_to_segment(ring_item);
+                m_ring.clear();
+                m_ring_bytes = 0;
+            }
+            if(!item) return;
+            //samples that were queued before the trigger but are older than the ring duration are not written
+            if(m_file && item->sample->info.capture_time >= m_trigger_start_time)
+            {
+                uint64_t trigger_end_time = 0;
+                {
+                    //a trigger that was called while the file is written extends the trigger end time
+                    std::lock_guard<std::mutex> guard(m_main_mutex);
+                    trigger_end_time = m_trigger_end_time;
+                    if(item->sample->info.capture_time > trigger_end_time)
+                        m_is_trigger_pending = false;
+                }
+                if(item->sample->info.capture_time <= trigger_end_time)
+                {
+                    write_to_segment(item);
+                    return;
+                }
+                close_segment();
+                m_segment_index++;
+            }
+
+            auto ring_item = item;
+            auto frame = std::dynamic_pointer_cast<file_types::frame_sample>(item->sample);
+            if(frame)
+            {
+                //the source frame is released, encoded frames keep only the encoded data and other frames keep a copy of the raw data
+                ring_item = std::make_shared<sample_to_write>();
+                if(item->is_encoded)
+                {
+                    ring_item->sample = std::make_shared<file_types::frame_sample>(frame.get());
+                    ring_item->encoded_data.assign(item->encoded_data.begin(), item->encoded_data.begin() + item->encoded_data_size);
+                }
+                else
+                {
+                    size_t size = static_cast<size_t>(frame->finfo.stride * frame->finfo.height);
+                    auto buffer = m_ring_frames_pool.acquire(size);
+                    if(frame->data)
+                        memcpy(buffer.get(), frame->data, size);
+                    auto ring_frame = std::shared_ptr<file_types::frame_sample>(
+                    new file_types::frame_sample(frame.get()), [buffer](file_types::frame_sample* f) { delete f; });
+                    ring_frame->data = buffer.get();
+                    ring_item->sample = ring_frame;
+                }
+                ring_item->encoded_data_size = item->encoded_data_size;
+                ring_item->encode_status = item->encode_status;
+                ring_item->is_encoded = item->is_encoded;
+                ring_item->is_ready = true;
+                ring_item->is_encoding = false;
+                ring_item->is_dropped = false;
+                ring_item->queued_time = item->queued_time;
+            }
+            ring_item->size = get_ring_item_size(ring_item);
+            m_ring.push_back(ring_item);
+            m_ring_bytes += ring_item->size;
+
+            //the newest sample is always kept, even if it exceeds the ring size by itself
+            uint64_t max_ring_size = m_config.m_ring_size > 0 ? m_config.m_ring_size : m_memory_budget;
+            auto newest_time = ring_item->sample->info.capture_time;
+            while(m_ring.size() > 1 && (m_ring.front()->sample->info.capture_time + m_config.m_ring_duration < newest_time || m_ring_bytes > max_ring_size))
+            {
+                m_ring_bytes -= m_ring.front()->size;
+                m_ring.pop_front();
             }
         }
 
+        uint64_t disk_write::get_ring_item_size(const std::shared_ptr<sample_to_write> &item)
+        {
+            if(item->is_encoded)
+                return sizeof(sample_to_write) + sizeof(file_types::frame_sample) + item->encoded_data.capacity();
+            return sizeof(sample_to_write) + get_sample_size(item->sample);
+        }
+
+        status disk_write::trigger(uint64_t post_trigger_duration)
+        {
+            std::lock_guard<std::mutex> guard(m_main_mutex);
+            if(m_config.m_ring_duration == 0) return status::status_feature_unsupported;
+            if(m_stop_writing) return status::status_exec_aborted;
+            //the trigger time is the capture time of the newest recorded sample
+            uint64_t last_queued_capture_time = m_last_queued_capture_time;
+            auto trigger_end_time = last_queued_capture_time + post_trigger_duration;
+            if(!m_is_trigger_pending)
+                m_trigger_start_time = last_queued_capture_time > m_config.m_ring_duration ? last_queued_capture_time - m_config.m_ring_duration : 0;
+            if(!m_is_trigger_pending || trigger_end_time > m_trigger_end_time)
+                m_trigger_end_time = trigger_end_time;
+            m_is_trigger_pending = true;
+            m_notify_write_thread_cv.notify_one();
+            return status::status_no_error;
+        }
+
         void disk_write::write_header(uint8_t stream_count, file_types::coordinate_system cs, playback::capture_mode capture_mode)
         {
             file_types::disk_format::file_header header = {};
-            header.data.version = 2;
+            header.data.version = 4;
             header.data.id = UID('R', 'S', 'L', '0' + header.data.version);
             header.data.coordinate_system = cs;
             header.data.capture_mode = capture_mode;
@@ -315,10 +938,6 @@ namespace rs
                 auto stream = iter->first;
                 sinfo.ctype = m_encoder->get_compression_type(stream);
                 sinfo.profile = iter->second;
-                /* Save the stream nframes offset for later update */
-                uint64_t pos = 0;
-                m_file->set_position(pos, move_method::current, &pos);
-                m_offsets[stream] = pos + offsetof(file_types::stream_info, nframes);
                 sinfo.stream = stream;
                 file_types::disk_format::stream_info stream_info = {};
                 stream_info.data = sinfo;
@@ -367,56 +986,126 @@ namespace rs
 
         }
 
-        void disk_write::write_stream_num_of_frames(rs_stream stream, int32_t frame_count)
+        void disk_write::write_trailer()
+        {
+            uint64_t trailer_offset = 0;
+            m_file->get_position(&trailer_offset);
+
+            write_frame_indexing();
+            write_frame_count();
+
+            //point the file header to the trailer chunks, this is the only seek back done after the first frame was written
+            uint32_t bytes_written = 0;
+            m_file->set_position((int64_t)offsetof(file_types::disk_format::file_header, trailer_offset), move_method::begin);
+            int64_t offset = (int64_t)trailer_offset;
+            write_to_file(&offset, sizeof(offset), bytes_written);
+            LOG_INFO("trailer offset - " << trailer_offset)
+        }
+
+        void disk_write::add_to_frame_indexing(const std::shared_ptr<file_types::sample> &sample)
+        {
+            file_types::packed::writer writer(m_frame_indexing);
+            file_types::packed::write_record(writer, sample, m_index_context);
+        }
+
+        void disk_write::write_samples_batch()
         {
-            auto it = m_offsets.find(stream);
-            if(it == m_offsets.end()) return;
-            uint64_t pos;
+            if(m_samples_batch.empty()) return;
+            //all the samples of the batch point to the batch chunk
+            uint64_t pos = 0;
             m_file->get_position(&pos);
+            std::vector<uint8_t> records;
+            file_types::packed::writer writer(records);
+            for(auto & sample : m_samples_batch)
+            {
+                sample->info.offset = pos;
+                file_types::packed::write_record(writer, sample, m_file_context);
+            }
+
+            file_types::chunk_info chunk = {};
+            chunk.id = file_types::chunk_id::chunk_samples_batch;
+            chunk.size = static_cast<int32_t>(records.size());
             uint32_t bytes_written = 0;
-            m_file->set_position(it->second, move_method::begin);
-            write_to_file(&frame_count, sizeof(int32_t), bytes_written);
-            m_file->set_position(pos, move_method::begin);
-            LOG_VERBOSE("stream - " << stream << " ,number of frames - " << frame_count)
+            write_to_file(&chunk, sizeof(chunk), bytes_written);
+            write_to_file(records.data(), chunk.size, bytes_written);
+            for(auto & sample : m_samples_batch)
+                add_to_frame_indexing(sample);
+            LOG_VERBOSE("write samples batch chunk, number of samples - " << m_samples_batch.size())
+            m_samples_batch.clear();
         }
 
-        void disk_write::write_sample_info(std::shared_ptr<file_types::sample> &sample)
+        void disk_write::write_frame_indexing()
         {
             file_types::chunk_info chunk = {};
-            chunk.id = file_types::chunk_id::chunk_sample_info;
-            chunk.size = sizeof(file_types::disk_format::sample_info);
-            file_types::disk_format::sample_info sample_info;
+            chunk.id = file_types::chunk_id::chunk_frame_indexing;
+            chunk.size = static_cast<int32_t>(m_frame_indexing.size());
+
+            uint32_t bytes_written = 0;
+            write_to_file(&chunk, sizeof(chunk), bytes_written);
+            write_to_file(m_frame_indexing.data(), chunk.size, bytes_written);
+            LOG_INFO("write frame indexing chunk, chunk size - " << chunk.size)
+        }
 
+        void disk_write::write_frame_count()
+        {
+            std::vector<file_types::frame_count> frame_count;
+            for(auto it = m_number_of_frames.begin(); it != m_number_of_frames.end(); ++it)
+            {
+                file_types::frame_count fc = {it->first, it->second};
+                frame_count.push_back(fc);
+                LOG_INFO("stream - " << it->first << " ,number of frames - " << it->second)
+            }
+
+            file_types::chunk_info chunk = {};
+            chunk.id = file_types::chunk_id::chunk_frame_count;
+            chunk.size = static_cast<int32_t>(frame_count.size() * sizeof(file_types::frame_count));
+
+            uint32_t bytes_written = 0;
+            write_to_file(&chunk, sizeof(chunk), bytes_written);
+            write_to_file(frame_count.data(), chunk.size, bytes_written);
+            LOG_INFO("write frame count chunk, chunk size - " << chunk.size)
+        }
+
+        void disk_write::write_sample_info(std::shared_ptr<file_types::sample> &sample)
+        {
             uint64_t pos = 0;
             m_file->get_position(&pos);
             sample->info.offset = pos;
 
-            sample_info.data = sample->info;
+            std::vector<uint8_t> sample_info;
+            file_types::packed::writer writer(sample_info);
+            file_types::packed::write_sample_info(writer, sample->info, m_file_context);
+
+            file_types::chunk_info chunk = {};
+            chunk.id = file_types::chunk_id::chunk_sample_info;
+            chunk.size = static_cast<int32_t>(sample_info.size());
             uint32_t bytes_written = 0;
             write_to_file(&chunk, sizeof(chunk), bytes_written);
-            write_to_file(&sample_info, chunk.size, bytes_written);
+            write_to_file(sample_info.data(), chunk.size, bytes_written);
         }
 
-        void disk_write::write_sample(std::shared_ptr<file_types::sample> &sample)
+        void disk_write::write_sample(std::shared_ptr<sample_to_write> &item)
         {
+            auto & sample = item->sample;
             switch(sample->info.type)
             {
                 case file_types::sample_type::st_image:
                 {
-                    file_types::chunk_info chunk = {};
-                    chunk.id = file_types::chunk_id::chunk_frame_info;
-                    file_types::disk_format::frame_info frame_info = {};
-                    chunk.size = sizeof(frame_info);
                     auto frame = std::dynamic_pointer_cast<file_types::frame_sample>(sample);
                     if (frame)
                     {
-                        frame_info.data = frame->finfo;
+                        std::vector<uint8_t> frame_info;
+                        file_types::packed::writer writer(frame_info);
+                        file_types::packed::write_frame_info(writer, frame->finfo, m_file_context);
 
+                        file_types::chunk_info chunk = {};
+                        chunk.id = file_types::chunk_id::chunk_frame_info;
+                        chunk.size = static_cast<int32_t>(frame_info.size());
                         uint32_t bytes_written = 0;
                         write_to_file(&chunk, sizeof(chunk), bytes_written);
-                        write_to_file(&frame_info, chunk.size, bytes_written);
+                        write_to_file(frame_info.data(), chunk.size, bytes_written);
                         write_frame_metadata_chunk(frame->metadata);
-                        write_image_data(sample);
+                        write_image_data(item);
                         LOG_VERBOSE("write frame, stream type - " << frame->finfo.stream << " capture time - " << frame->info.capture_time);
                         LOG_VERBOSE("write frame, stream type - " << frame->finfo.stream << " system time - " << frame->finfo.system_time);
                         LOG_VERBOSE("write frame, stream type - " << frame->finfo.stream << " time stamp - " << frame->finfo.time_stamp);
@@ -424,40 +1113,7 @@ namespace rs
                     }
                     break;
                 }
-                case file_types::sample_type::st_motion:
-                {
-                    file_types::chunk_info chunk = {};
-                    chunk.id = file_types::chunk_id::chunk_sample_data;
-                    file_types::disk_format::motion_data motion_data = {};
-                    chunk.size = sizeof(motion_data);
-                    auto motion = std::dynamic_pointer_cast<file_types::motion_sample>(sample);
-                    if (motion)
-                    {
-                        motion_data.data = motion->data;
-                        uint32_t bytes_written = 0;
-                        write_to_file(&chunk, sizeof(chunk), bytes_written);
-                        write_to_file(&motion_data, chunk.size, bytes_written);
-                        LOG_VERBOSE("write motion, relative time - " << motion->info.capture_time)
-                    }
-                    break;
-                }
-                case file_types::sample_type::st_time:
-                {
-                    file_types::chunk_info chunk = {};
-                    chunk.id = file_types::chunk_id::chunk_sample_data;
-                    file_types::disk_format::time_stamp_data time_stamp_data = {};
-                    chunk.size = sizeof(time_stamp_data);
-                    auto time = std::dynamic_pointer_cast<file_types::time_stamp_sample>(sample);
-                    if (time)
-                    {
-                        time_stamp_data.data = time->data;
-                        uint32_t bytes_written = 0;
-                        write_to_file(&chunk, sizeof(chunk), bytes_written);
-                        write_to_file(&time_stamp_data, chunk.size, bytes_written);
-                        LOG_VERBOSE("write time stamp, relative time - " << time->info.capture_time)
-                    }
-                    break;
-                }
+                default: break;//motion and time stamp samples are written by write_samples_batch
             }
         }
 
@@ -485,39 +1141,43 @@ namespace rs
             write_to_file(metadata_pairs.data(), num_bytes_to_write, bytes_written);
         }
 
-        void disk_write::write_image_data(std::shared_ptr<file_types::sample> &sample)
+        void disk_write::write_image_data(std::shared_ptr<sample_to_write> &item)
         {
-            auto frame = std::dynamic_pointer_cast<file_types::frame_sample>(sample);
+            auto frame = std::dynamic_pointer_cast<file_types::frame_sample>(item->sample);
 
             if (frame)
             {
                 /* Get raw stream size */
                 int32_t nbytes = (frame->finfo.stride * frame->finfo.height);
 
-                uint32_t compressed_data_size = 0;
-                auto encode = m_encoder->get_compression_type(frame->finfo.stream) != file_types::compression_type::none;
+                auto encode = item->is_encoded;
+                if(encode && item->encode_status != status::status_no_error)
+                    throw std::runtime_error("Failed to encode frame");
 
-                if(encode)
-                {
-                    auto sts = m_encoder->encode_frame(frame->finfo, frame->data, m_encoded_data.data(), compressed_data_size);
-                    if(sts != status::status_no_error)
-                        throw std::runtime_error("Failed to encode frame");
-                }
-
-                const uint8_t * data = encode ? m_encoded_data.data() : frame->data;
+                const uint8_t * data = encode ? item->encoded_data.data() : frame->data;
 
                 file_types::chunk_info chunk = {};
                 chunk.id = file_types::chunk_id::chunk_sample_data;
-                chunk.size = encode ? compressed_data_size : nbytes;
+                chunk.size = encode ? item->encoded_data_size : nbytes;
 
                 uint32_t bytes_written = 0;
                 m_file->write_bytes(&chunk, sizeof(chunk), bytes_written);
                 m_file->write_bytes(data, chunk.size, bytes_written);
 
                 m_number_of_frames[frame->finfo.stream]++;
-                write_stream_num_of_frames(frame->finfo.stream, m_number_of_frames[frame->finfo.stream]);
-                std::lock_guard<std::mutex> guard(m_main_mutex);
-                m_samples_count[frame->finfo.stream]--;
+
+                auto counters = get_stream_counters(item->sample);
+                if(counters)
+                {
+                    auto latency = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                                             std::chrono::steady_clock::now() - item->queued_time).count());
+                    counters->frames_written++;
+                    counters->bytes_in += static_cast<uint64_t>(nbytes);
+                    counters->bytes_out += static_cast<uint64_t>(chunk.size);
+                    counters->total_latency += latency;
+                    auto max_latency = counters->max_latency.load();
+                    while(latency > max_latency && !counters->max_latency.compare_exchange_weak(max_latency, latency));
+                }
             }
         }
     }
@@ -3,7 +3,9 @@
 
 #pragma once
 #include <vector>
+#include <atomic>
 #include <queue>
+#include <deque>
 #include <map>
 #include <set>
 #include <list>
@@ -11,9 +13,13 @@
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <chrono>
 #include <condition_variable>
 #include "compression/encoder.h"
 #include "include/file_types.h"
+#include "include/packed_format.h"
+#include "include/spsc_queue.h"
+#include "include/buffer_pool.h"
 #include "rs/core/image_interface.h"
 #include "rs/record/record_device.h"
 #include "include/file.h"
@@ -33,6 +39,44 @@ namespace rs
             rs_motion_intrinsics                                            m_motion_intrinsics;
             playback::capture_mode                                          m_capture_mode;
             std::map<rs_stream,record::compression_level>                   m_compression_config;
+            std::set<rs_stream>                                             m_lossy_compression_streams; //color streams compressed with the lossy codec
+            uint32_t                                                        m_encoder_threads_count; //0 - one encoder thread per stream, bounded by the hardware threads
+            uint32_t                                                        m_compression_stripes_count; //0 or 1 - each frame is compressed as a single block
+            bool                                                            m_direct_io; //bypass the page cache, supported on linux only
+            uint64_t                                                        m_file_preallocation_size; //0 - no preallocation, supported on linux only
+            uint64_t                                                        m_memory_budget; //0 - 100MB per stream
+            back_pressure_policy                                            m_back_pressure_policy;
+            uint64_t                                                        m_segment_size; //0 - no size limit, a new segment file is started when the limit is reached
+            uint64_t                                                        m_segment_duration; //microseconds, 0 - no duration limit
+            uint64_t                                                        m_ring_duration; //microseconds, 0 - samples are written to file, otherwise kept in a ring until triggered
+            uint64_t                                                        m_ring_size; //bytes, 0 - the memory budget
+        };
+
+        struct sample_to_write
+        {
+            std::shared_ptr<core::file_types::sample>                       sample;
+            uint64_t                                                        size; //memory accounted for the sample
+            std::vector<uint8_t>                                            encoded_data;
+            uint32_t                                                        encoded_data_size;
+            core::status                                                    encode_status;
+            bool                                                            is_encoded;
+            bool                                                            is_ready; //encoded or doesn't require encoding
+            bool                                                            is_encoding; //taken by an encoder thread and not encoded yet
+            bool                                                            is_dropped;
+            std::chrono::steady_clock::time_point                           queued_time;
+        };
+
+        //updated concurrently by the callback threads, the encoder threads and the write thread
+        struct stream_counters
+        {
+            std::atomic<uint64_t>                                           frames_received;
+            std::atomic<uint64_t>                                           frames_written;
+            std::atomic<uint64_t>                                           frames_dropped;
+            std::atomic<uint64_t>                                           bytes_in;
+            std::atomic<uint64_t>                                           bytes_out;
+            std::atomic<uint64_t>                                           queued_frames;
+            std::atomic<uint64_t>                                           total_latency; //microseconds
+            std::atomic<uint64_t>                                           max_latency; //microseconds
         };
 
         class disk_write
@@ -46,9 +90,28 @@ namespace rs
             bool is_configured() {return m_is_configured;}
             core::status configure(const configuration &config);
             void record_sample(std::shared_ptr<core::file_types::sample> &sample);
+            queue_status get_queue_status();
+            stream_statistics get_stream_statistics(rs_stream stream);
+            //dump the ring buffer to a new file, and keep writing the samples captured up to post trigger duration after the newest sample
+            core::status trigger(uint64_t post_trigger_duration);
 
         private:
             void write_thread();
+            //segments are self contained files, the write thread starts a new segment when the current one reaches its size or duration limit
+            void open_segment();
+            void close_segment();
+            bool is_segment_full(const std::shared_ptr<core::file_types::sample> &sample);
+            static std::string get_segment_path(const std::string &file_path, uint32_t segment_index);
+            void write_to_segment(std::shared_ptr<sample_to_write> &item);
+            //keep the encoded samples of the last ring duration in memory, up to the ring size, the ring is written to file when triggered
+            void write_to_ring(std::shared_ptr<sample_to_write> &item, bool is_triggered);
+            uint64_t get_ring_item_size(const std::shared_ptr<sample_to_write> &item);
+            //encoder threads compress frames concurrently, the write thread writes the samples in capture order
+            void encode_thread();
+            void encode_sample(std::shared_ptr<sample_to_write> &item);
+            //raise the compression speed under pressure and lower it when there is headroom, for streams with adaptive compression level
+            void adapt_compression(double encode_time);
+            uint32_t get_encoder_threads_count(const configuration& config);
             void write_header(uint8_t stream_count, core::file_types::coordinate_system cs, playback::capture_mode capture_mode);
             void write_camera_info(const std::map<rs_camera_info, std::pair<uint32_t, const char *> > &camera_info);
             void write_sw_info();
@@ -59,32 +122,90 @@ namespace rs
             void write_motion_intrinsics(const rs_motion_intrinsics &motion_intrinsics);
             void write_properties(const std::vector<core::file_types::device_cap> &properties);
             void write_first_frame_offset();
-            void write_stream_num_of_frames(rs_stream stream, int32_t frame_count);
+            //frames count is kept in memory while recording and written once, when the record is finalized
+            void write_trailer();
+            void write_frame_count();
+            void write_frame_indexing();
+            void add_to_frame_indexing(const std::shared_ptr<rs::core::file_types::sample> &sample);
+            //motion and time stamp samples are written in batches, as a single chunk of index records
+            void write_samples_batch();
             //sample type is written separatly since we need to know how to read the sample info
             void write_sample_info(std::shared_ptr<rs::core::file_types::sample> &sample);
-            void write_sample(std::shared_ptr<rs::core::file_types::sample> &sample);
+            void write_sample(std::shared_ptr<sample_to_write> &item);
             void write_frame_metadata_chunk(const std::map<rs_frame_metadata, double>& metadata);
-            void write_image_data(std::shared_ptr<rs::core::file_types::sample> &sample);
+            void write_image_data(std::shared_ptr<sample_to_write> &item);
             void write_to_file(const void* data, unsigned int numberOfBytesToWrite, unsigned int& numberOfBytesWritten);
-            bool allow_sample(std::shared_ptr<rs::core::file_types::sample> &sample);
+            uint64_t get_sample_size(const std::shared_ptr<rs::core::file_types::sample> &sample);
+            //the queued samples memory is accounted without locking, to queue samples on the callback threads without locking
+            bool is_memory_available(uint64_t size);
+            bool try_reserve_memory(uint64_t size);
+            //apply the back pressure policy until the sample fits the memory budget, returns false if the sample should be dropped
+            bool reserve_memory(std::unique_lock<std::mutex> &guard, uint64_t size);
+            void drop_sample(const std::shared_ptr<rs::core::file_types::sample> &sample, uint64_t size);
             uint32_t get_min_fps(const std::map<rs_stream, core::file_types::stream_profile>& stream_profiles);
             void init_encoder(const configuration& config);
+            typedef core::spsc_queue<std::shared_ptr<sample_to_write>> sample_queue;
+            sample_queue * get_source_queue(const std::shared_ptr<core::file_types::sample> &sample);
+            //returns nullptr for motion and time stamp samples
+            stream_counters * get_stream_counters(const std::shared_ptr<core::file_types::sample> &sample);
+            void notify_waiting_threads();
+            //the following functions are called with m_main_mutex locked
+            bool queue_sample(const std::shared_ptr<sample_to_write> &item);
+            //move the samples of the source queues to the samples queue, the source queues are drained by a single thread at a time
+            void dispatch_samples();
+            //drop the samples that were queued while stopping and release their memory reservation
+            void release_source_queues();
+            template<typename predicate>
+            void wait_for_samples(std::unique_lock<std::mutex> &guard, std::condition_variable &cv, predicate is_ready);
 
-            std::mutex                                                      m_main_mutex; //protect m_samples_queue, m_stop_thred
-            std::mutex                                                      m_notify_write_thread_mutex;
+            std::mutex                                                      m_main_mutex; //protect m_samples_queue, m_encode_queue, m_stop_thred and the source queues consumer side
             std::condition_variable                                         m_notify_write_thread_cv;
+            std::condition_variable                                         m_notify_producer_cv;
+            std::condition_variable                                         m_notify_encoder_threads_cv;
             std::thread                                                     m_thread;
-            bool                                                            m_stop_writing;
-            std::queue<std::shared_ptr<core::file_types::sample>>           m_samples_queue;
+            std::vector<std::thread>                                        m_encoder_threads;
+            uint32_t                                                        m_encoder_threads_count;
+            std::atomic<bool>                                               m_stop_writing; //read without locking by the callback threads
+            std::deque<std::shared_ptr<sample_to_write>>                    m_samples_queue; //samples in capture order
+            std::queue<std::shared_ptr<sample_to_write>>                    m_encode_queue;
             std::unique_ptr<core::compression::encoder>                     m_encoder;
-            std::vector<uint8_t>                                            m_encoded_data;
             std::unique_ptr<core::file>                                     m_file;
             bool                                                            m_paused;
-            std::map<rs_stream, int64_t>                                    m_offsets;
             std::map<rs_stream, int32_t>                                    m_number_of_frames;
+            std::vector<uint8_t>                                            m_frame_indexing;
+            core::file_types::packed::context                               m_index_context; //delta coding state of the frame indexing records
+            core::file_types::packed::context                               m_file_context; //delta coding state of the per sample chunks, in file order
             bool                                                            m_is_configured;
-            std::map<rs_stream, uint32_t>                                   m_samples_count;
             uint32_t                                                        m_min_fps;
+            uint64_t                                                        m_memory_budget;
+            back_pressure_policy                                            m_back_pressure_policy;
+            std::atomic<uint64_t>                                           m_queued_bytes;
+            std::atomic<uint64_t>                                           m_peak_queued_bytes;
+            std::atomic<uint64_t>                                           m_dropped_samples;
+            std::atomic<uint64_t>                                           m_dropped_bytes;
+            std::map<rs_stream, std::unique_ptr<sample_queue>>              m_frame_queues; //single producer per stream
+            std::unique_ptr<sample_queue>                                   m_motion_queue;
+            std::unique_ptr<sample_queue>                                   m_time_stamp_queue;
+            std::vector<sample_queue*>                                      m_source_queues;
+            std::atomic<int>                                                m_waiting_threads_count; //threads waiting on the source queues
+            std::map<rs_stream, std::unique_ptr<stream_counters>>           m_stream_counters; //created on configure
+            int                                                             m_acceleration;
+            double                                                          m_encode_time; //average encode time of the adaptive streams frames in seconds
+            uint32_t                                                        m_adaptive_frames_rate; //frames per second of the adaptive streams
+            std::chrono::steady_clock::time_point                           m_last_adaptation;
+            configuration                                                   m_config;
+            uint32_t                                                        m_segment_index;
+            uint64_t                                                        m_segment_start_time;
+            uint64_t                                                        m_last_capture_time;
+            bool                                                            m_is_segment_empty;
+            std::vector<std::shared_ptr<core::file_types::sample>>          m_samples_batch;
+            std::deque<std::shared_ptr<sample_to_write>>                    m_ring; //accessed by the write thread only
+            std::atomic<uint64_t>                                           m_ring_bytes;
+            core::buffer_pool                                               m_ring_frames_pool; //copies of the frames which are not encoded, the source frames are not held by the ring
+            bool                                                            m_is_trigger_pending;
+            uint64_t                                                        m_trigger_start_time; //written by trigger before the write thread is notified
+            uint64_t                                                        m_trigger_end_time;
+            std::atomic<uint64_t>                                           m_last_queued_capture_time;
         };
     }
 }
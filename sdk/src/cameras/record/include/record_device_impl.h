@@ -3,8 +3,10 @@
 
 #pragma once
 #include <mutex>
+#include <set>
 #include "record_device_interface.h"
 #include "disk_write.h"
+#include "include/buffer_pool.h"
 
 namespace rs
 {
@@ -62,6 +64,16 @@ namespace rs
             virtual void                            resume_record() override;
             virtual bool                            set_compression(rs_stream stream, record::compression_level compression_level) override;
             virtual record::compression_level       get_compression(rs_stream stream) override;
+            virtual core::status                    set_lossy_compression(rs_stream stream, bool enabled) override;
+            virtual core::status                    set_compression_threads_count(uint32_t threads_count) override;
+            virtual core::status                    set_compression_stripes_count(uint32_t stripes_count) override;
+            virtual core::status                    set_memory_budget(uint64_t max_queued_bytes, record::back_pressure_policy policy) override;
+            virtual record::queue_status            get_queue_status() override;
+            virtual record::stream_statistics       get_stream_statistics(rs_stream stream) override;
+            virtual core::status                    set_segment_limits(uint64_t max_segment_size, uint64_t max_segment_duration) override;
+            virtual core::status                    set_file_write_options(bool direct_io, uint64_t preallocation_size) override;
+            virtual core::status                    set_ring_buffer_duration(uint64_t duration, uint64_t max_size) override;
+            virtual core::status                    trigger_ring_buffer_dump(uint64_t post_trigger_duration) override;
 
         private:
             void write_samples();
@@ -88,6 +100,18 @@ namespace rs
             bool                                                                    m_is_motion_tracking_enabled;
             playback::capture_mode                                                  m_capture_mode;
             std::map<rs_stream, compression_level>                                  m_compression_config;
+            std::set<rs_stream>                                                     m_lossy_compression_streams;
+            uint32_t                                                                m_compression_threads_count;
+            uint32_t                                                                m_compression_stripes_count;
+            uint64_t                                                                m_memory_budget;
+            back_pressure_policy                                                    m_back_pressure_policy;
+            uint64_t                                                                m_segment_size;
+            uint64_t                                                                m_segment_duration; //milliseconds
+            bool                                                                    m_direct_io;
+            uint64_t                                                                m_file_preallocation_size; //bytes, 0 - no preallocation
+            uint64_t                                                                m_ring_buffer_duration; //milliseconds
+            uint64_t                                                                m_ring_buffer_size; //bytes, 0 - the memory budget
+            core::buffer_pool                                                       m_frames_buffer_pool; //synced frames are copied to recycled buffers
         };
     }
 }
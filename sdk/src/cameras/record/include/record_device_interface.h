@@ -18,6 +18,16 @@ namespace rs
             virtual void resume_record() = 0;
             virtual bool set_compression(rs_stream stream, record::compression_level compression_level) = 0;
             virtual record::compression_level get_compression(rs_stream stream) = 0;
+            virtual core::status set_lossy_compression(rs_stream stream, bool enabled) = 0;
+            virtual core::status set_compression_threads_count(uint32_t threads_count) = 0;
+            virtual core::status set_compression_stripes_count(uint32_t stripes_count) = 0;
+            virtual core::status set_memory_budget(uint64_t max_queued_bytes, record::back_pressure_policy policy) = 0;
+            virtual record::queue_status get_queue_status() = 0;
+            virtual record::stream_statistics get_stream_statistics(rs_stream stream) = 0;
+            virtual core::status set_segment_limits(uint64_t max_segment_size, uint64_t max_segment_duration) = 0;
+            virtual core::status set_file_write_options(bool direct_io, uint64_t preallocation_size) = 0;
+            virtual core::status set_ring_buffer_duration(uint64_t duration, uint64_t max_size) = 0;
+            virtual core::status trigger_ring_buffer_dump(uint64_t post_trigger_duration) = 0;
         };
     }
 }
@@ -4,12 +4,16 @@
 #include <algorithm>
 #include "record_device_impl.h"
 #include "image/image_utils.h"
+#include "compression/striped_lz4_codec.h"
 #include "rs/utils/log_utils.h"
 
 using namespace rs::core;
 
 namespace
 {
+    //by default the record file grows by large steps to reduce file system fragmentation
+    static const uint64_t FILE_PREALLOCATION_SIZE = 64 << 20;
+
     static rs_capabilities get_capability(rs_stream stream)
     {
         switch(stream)
@@ -113,7 +117,17 @@ namespace rs
             m_device(device),
             m_file_path(file_path),
             m_is_streaming(false),
-            m_capture_mode(playback::capture_mode::synced)
+            m_capture_mode(playback::capture_mode::synced),
+            m_compression_threads_count(0),
+            m_compression_stripes_count(1),
+            m_memory_budget(0),
+            m_back_pressure_policy(back_pressure_policy::drop_newest),
+            m_segment_size(0),
+            m_segment_duration(0),
+            m_direct_io(false),
+            m_file_preallocation_size(FILE_PREALLOCATION_SIZE),
+            m_ring_buffer_duration(0),
+            m_ring_buffer_size(0)
         {
 
         }
@@ -438,7 +452,8 @@ namespace rs
                 case record::compression_level::disabled:
                 case record::compression_level::low:
                 case record::compression_level::medium:
-                case record::compression_level::high: m_compression_config[stream] = compression_level; return true;
+                case record::compression_level::high:
+                case record::compression_level::adaptive: m_compression_config[stream] = compression_level; return true;
                 default: return false;
             }
         }
@@ -450,6 +465,86 @@ namespace rs
             return m_compression_config[stream];
         }
 
+        status rs_device_ex::set_lossy_compression(rs_stream stream, bool enabled)
+        {
+            if(m_is_streaming) return status::status_exec_aborted;
+            if(enabled)
+                m_lossy_compression_streams.insert(stream);
+            else
+                m_lossy_compression_streams.erase(stream);
+            return status::status_no_error;
+        }
+
+        status rs_device_ex::set_compression_threads_count(uint32_t threads_count)
+        {
+            if(m_is_streaming) return status::status_exec_aborted;
+            m_compression_threads_count = threads_count;
+            return status::status_no_error;
+        }
+
+        status rs_device_ex::set_compression_stripes_count(uint32_t stripes_count)
+        {
+            if(m_is_streaming) return status::status_exec_aborted;
+            if(stripes_count == 0 || stripes_count > core::compression::striped_lz4_codec::MAX_STRIPES_COUNT) return status::status_invalid_argument;
+            m_compression_stripes_count = stripes_count;
+            return status::status_no_error;
+        }
+
+        status rs_device_ex::set_memory_budget(uint64_t max_queued_bytes, record::back_pressure_policy policy)
+        {
+            if(m_is_streaming) return status::status_exec_aborted;
+            switch(policy)
+            {
+                case record::back_pressure_policy::drop_newest:
+                case record::back_pressure_policy::drop_oldest:
+                case record::back_pressure_policy::block:
+                    m_memory_budget = max_queued_bytes;
+                    m_back_pressure_policy = policy;
+                    return status::status_no_error;
+                default: return status::status_invalid_argument;
+            }
+        }
+
+        record::queue_status rs_device_ex::get_queue_status()
+        {
+            return m_disk_write.get_queue_status();
+        }
+
+        record::stream_statistics rs_device_ex::get_stream_statistics(rs_stream stream)
+        {
+            return m_disk_write.get_stream_statistics(stream);
+        }
+
+        status rs_device_ex::set_segment_limits(uint64_t max_segment_size, uint64_t max_segment_duration)
+        {
+            if(m_is_streaming) return status::status_exec_aborted;
+            m_segment_size = max_segment_size;
+            m_segment_duration = max_segment_duration;
+            return status::status_no_error;
+        }
+
+        status rs_device_ex::set_file_write_options(bool direct_io, uint64_t preallocation_size)
+        {
+            if(m_is_streaming) return status::status_exec_aborted;
+            m_direct_io = direct_io;
+            m_file_preallocation_size = preallocation_size;
+            return status::status_no_error;
+        }
+
+        status rs_device_ex::set_ring_buffer_duration(uint64_t duration, uint64_t max_size)
+        {
+            if(m_is_streaming) return status::status_exec_aborted;
+            m_ring_buffer_duration = duration;
+            m_ring_buffer_size = max_size;
+            return status::status_no_error;
+        }
+
+        status rs_device_ex::trigger_ring_buffer_dump(uint64_t post_trigger_duration)
+        {
+            if(!m_is_streaming) return status::status_exec_aborted;
+            return m_disk_write.trigger(post_trigger_duration * 1000);//capture time is in microseconds
+        }
+
         uint64_t rs_device_ex::get_capture_time()
         {
             LOG_FUNC_SCOPE();
@@ -522,8 +617,16 @@ namespace rs
                 if(m_device->get_stream_interface(*it).get_frame_number() == 0) continue;
 #endif
                 file_types::frame_sample frame(*it, m_device->get_stream_interface(*it), capture_time);
-                std::shared_ptr<file_types::sample> sample = std::shared_ptr<file_types::sample>(frame.copy(),
-                [](file_types::sample* f) { delete[] (static_cast<file_types::frame_sample*>(f))->data; delete f;});
+
+                //the synced frame data is owned by the device until the next wait for frames,
+                //hold a copy in a pooled buffer so no allocation is done per frame
+                size_t size = frame.finfo.stride * frame.finfo.height;
+                auto buffer = m_frames_buffer_pool.acquire(size);
+                memcpy(buffer.get(), frame.data, size);
+                auto frame_copy = new file_types::frame_sample(&frame);
+                frame_copy->data = buffer.get();
+                std::shared_ptr<file_types::sample> sample = std::shared_ptr<file_types::sample>(frame_copy,
+                [buffer](file_types::sample* f) { delete f; });
                 m_disk_write.record_sample(sample);
             }
         }
@@ -540,6 +643,17 @@ namespace rs
             config.m_capture_mode = m_capture_mode;
             config.m_camera_info = get_all_camera_info();
             config.m_compression_config = m_compression_config;
+            config.m_lossy_compression_streams = m_lossy_compression_streams;
+            config.m_encoder_threads_count = m_compression_threads_count;
+            config.m_compression_stripes_count = m_compression_stripes_count;
+            config.m_direct_io = m_direct_io;
+            config.m_file_preallocation_size = m_file_preallocation_size;
+            config.m_memory_budget = m_memory_budget;
+            config.m_back_pressure_policy = m_back_pressure_policy;
+            config.m_segment_size = m_segment_size;
+            config.m_segment_duration = m_segment_duration * 1000;//capture time is in microseconds
+            config.m_ring_duration = m_ring_buffer_duration * 1000;
+            config.m_ring_size = m_ring_buffer_size;
             return m_disk_write.configure(config);
         }
 
@@ -630,5 +744,55 @@ namespace rs
         {
             return ((rs_device_ex*)this)->get_compression((rs_stream)stream);
         }
+
+        status device::set_lossy_compression(rs::stream stream, bool enabled)
+        {
+            return ((rs_device_ex*)this)->set_lossy_compression((rs_stream)stream, enabled);
+        }
+
+        status device::set_compression_threads_count(uint32_t threads_count)
+        {
+            return ((rs_device_ex*)this)->set_compression_threads_count(threads_count);
+        }
+
+        status device::set_compression_stripes_count(uint32_t stripes_count)
+        {
+            return ((rs_device_ex*)this)->set_compression_stripes_count(stripes_count);
+        }
+
+        status device::set_memory_budget(uint64_t max_queued_bytes, back_pressure_policy policy)
+        {
+            return ((rs_device_ex*)this)->set_memory_budget(max_queued_bytes, policy);
+        }
+
+        queue_status device::get_queue_status()
+        {
+            return ((rs_device_ex*)this)->get_queue_status();
+        }
+
+        stream_statistics device::get_stream_statistics(rs::stream stream)
+        {
+            return ((rs_device_ex*)this)->get_stream_statistics((rs_stream)stream);
+        }
+
+        status device::set_segment_limits(uint64_t max_segment_size, uint64_t max_segment_duration)
+        {
+            return ((rs_device_ex*)this)->set_segment_limits(max_segment_size, max_segment_duration);
+        }
+
+        status device::set_file_write_options(bool direct_io, uint64_t preallocation_size)
+        {
+            return ((rs_device_ex*)this)->set_file_write_options(direct_io, preallocation_size);
+        }
+
+        status device::set_ring_buffer_duration(uint64_t duration, uint64_t max_size)
+        {
+            return ((rs_device_ex*)this)->set_ring_buffer_duration(duration, max_size);
+        }
+
+        status device::trigger_ring_buffer_dump(uint64_t post_trigger_duration)
+        {
+            return ((rs_device_ex*)this)->trigger_ring_buffer_dump(post_trigger_duration);
+        }
     }
 }
@@ -0,0 +1,94 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2016 Intel Corporation. All Rights Reserved.
+
+#ifdef __linux__
+#include <stdio.h>
+#include <sys/stat.h>
+#include <vector>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "buffered_file.h"
+
+using namespace std;
+using namespace rs::core;
+
+namespace buffered_file_setup
+{
+    static const std::string file_path = "buffered_file_test.bin";
+    static const uint64_t preallocation_size = 4 << 20;
+
+    vector<uint8_t> create_data(size_t size)
+    {
+        vector<uint8_t> data(size);
+        for(size_t i = 0; i < size; i++)
+            data[i] = static_cast<uint8_t>(i * 7);
+        return data;
+    }
+
+    vector<uint8_t> read_file()
+    {
+        vector<uint8_t> data;
+        FILE * file = fopen(file_path.c_str(), "rb");
+        if(!file) return data;
+        uint8_t buffer[4096];
+        size_t count = 0;
+        while((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+            data.insert(data.end(), buffer, buffer + count);
+        fclose(file);
+        return data;
+    }
+}
+
+class buffered_file_tests : public testing::Test
+{
+protected:
+    virtual void TearDown()
+    {
+        ::remove(buffered_file_setup::file_path.c_str());
+    }
+
+    //writes the data in small and large writes, and updates the header after the data was flushed
+    void write_file(buffered_file & file, const vector<uint8_t> & data)
+    {
+        ASSERT_EQ(status_no_error, file.open(buffered_file_setup::file_path, open_file_option::write));
+        unsigned int written = 0;
+        ASSERT_EQ(status_no_error, file.write_bytes(data.data(), 100, written));
+        ASSERT_EQ(status_no_error, file.write_bytes(data.data() + 100, static_cast<unsigned int>(data.size() - 100), written));
+        ASSERT_EQ(status_no_error, file.set_position(0, move_method::begin));
+        ASSERT_EQ(status_no_error, file.write_bytes(data.data(), 16, written));
+        ASSERT_EQ(status_no_error, file.close());
+    }
+};
+
+TEST_F(buffered_file_tests, write_and_update)
+{
+    auto data = buffered_file_setup::create_data(3 << 20);
+    buffered_file file(1 << 20);
+    write_file(file, data);
+    ASSERT_TRUE(data == buffered_file_setup::read_file());
+}
+
+TEST_F(buffered_file_tests, preallocation_released_on_close)
+{
+    auto data = buffered_file_setup::create_data(1 << 20);
+    buffered_file file(1 << 16, false, buffered_file_setup::preallocation_size);
+    write_file(file, data);
+    ASSERT_TRUE(data == buffered_file_setup::read_file());
+
+    //the blocks preallocated past the end of the file are released
+    struct stat file_stat = {};
+    ASSERT_EQ(0, stat(buffered_file_setup::file_path.c_str(), &file_stat));
+    ASSERT_EQ(static_cast<off_t>(data.size()), file_stat.st_size);
+    ASSERT_LT(static_cast<uint64_t>(file_stat.st_blocks) * 512, buffered_file_setup::preallocation_size);
+}
+
+TEST_F(buffered_file_tests, direct_io)
+{
+    //an unaligned size, the tail is written when the file is closed
+    auto data = buffered_file_setup::create_data((2 << 20) + 123);
+    buffered_file file(1 << 20, true, buffered_file_setup::preallocation_size);
+    write_file(file, data);
+    ASSERT_TRUE(data == buffered_file_setup::read_file());
+}
+#endif
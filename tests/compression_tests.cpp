@@ -0,0 +1,267 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2016 Intel Corporation. All Rights Reserved.
+
+#include <vector>
+#include <memory>
+#include <map>
+#include <cstdlib>
+#include <string.h>
+
+#include "gtest/gtest.h"
+#include "compression/encoder.h"
+#include "compression/decoder.h"
+#include "compression/striped_lz4_codec.h"
+
+using namespace std;
+using namespace rs::core;
+using namespace rs::core::file_types;
+using namespace rs::core::compression;
+
+namespace compression_setup
+{
+    static const frame_info depth_info = {320, 240, RS_FORMAT_Z16, 640, 2, RS_STREAM_DEPTH};
+    //the height isn't a multiple of the stripes count
+    static const frame_info color_info = {320, 242, RS_FORMAT_RGB8, 960, 3, RS_STREAM_COLOR};
+    static const uint32_t stripes_count = 4;
+
+    //a smooth surface with sensor noise, which compresses as a real depth or color frame does
+    vector<uint8_t> create_frame_data(const frame_info & info)
+    {
+        vector<uint8_t> data(info.stride * info.height);
+        srand(1);
+        for(int y = 0; y < info.height; y++)
+        {
+            if(info.format == RS_FORMAT_Z16)
+            {
+                auto row = reinterpret_cast<uint16_t*>(data.data() + y * info.stride);
+                for(int x = 0; x < info.width; x++)
+                    row[x] = static_cast<uint16_t>(1000 + x * 2 + y * 3 + rand() % 4);
+            }
+            else
+            {
+                auto row = data.data() + y * info.stride;
+                for(int x = 0; x < info.width * info.bpp; x++)
+                    row[x] = static_cast<uint8_t>(x / info.bpp / 4 + y / 4 + (x % info.bpp) * 40);
+            }
+        }
+        return data;
+    }
+
+    shared_ptr<frame_sample> decode(decoder & frames_decoder, const frame_info & info, const vector<uint8_t> & encoded)
+    {
+        auto frame = make_shared<frame_sample>(info, 0);
+        return frames_decoder.decode_frame(frame, encoded.data(), static_cast<uint32_t>(encoded.size()));
+    }
+
+    vector<uint8_t> encode(encoder & frames_encoder, frame_info info, const vector<uint8_t> & data)
+    {
+        vector<uint8_t> encoded(frames_encoder.get_max_encoded_size(info));
+        uint32_t encoded_size = 0;
+        EXPECT_EQ(status_no_error, frames_encoder.encode_frame(info, data.data(), encoded.data(), encoded_size));
+        encoded.resize(encoded_size);
+        return encoded;
+    }
+}
+
+GTEST_TEST(compression_tests, z16_round_trip)
+{
+    encoder frames_encoder;
+    frames_encoder.add_codec(RS_STREAM_DEPTH, RS_FORMAT_Z16, rs::record::compression_level::high);
+    ASSERT_EQ(compression_type::z16_lz4, frames_encoder.get_compression_type(RS_STREAM_DEPTH));
+    decoder frames_decoder({{RS_STREAM_DEPTH, compression_type::z16_lz4}});
+
+    auto data = compression_setup::create_frame_data(compression_setup::depth_info);
+    auto encoded = compression_setup::encode(frames_encoder, compression_setup::depth_info, data);
+    ASSERT_LT(encoded.size(), data.size());
+
+    //the planes buffers are reused by the following frames
+    for(int i = 0; i < 2; i++)
+    {
+        auto frame = compression_setup::decode(frames_decoder, compression_setup::depth_info, encoded);
+        ASSERT_NE(nullptr, frame);
+        ASSERT_EQ(0, memcmp(data.data(), frame->data, data.size()));
+    }
+
+    //a truncated frame fails to decode
+    encoded.resize(encoded.size() / 2);
+    ASSERT_EQ(nullptr, compression_setup::decode(frames_decoder, compression_setup::depth_info, encoded));
+}
+
+GTEST_TEST(compression_tests, jpeg_round_trip)
+{
+    encoder frames_encoder;
+    frames_encoder.add_codec(RS_STREAM_COLOR, RS_FORMAT_RGB8, rs::record::compression_level::high, true);
+    ASSERT_EQ(compression_type::jpeg, frames_encoder.get_compression_type(RS_STREAM_COLOR));
+    decoder frames_decoder({{RS_STREAM_COLOR, compression_type::jpeg}});
+
+    auto data = compression_setup::create_frame_data(compression_setup::color_info);
+    auto encoded = compression_setup::encode(frames_encoder, compression_setup::color_info, data);
+    ASSERT_LT(encoded.size(), data.size());
+
+    //jpeg is lossy, the decoded frame is close to the original frame
+    auto frame = compression_setup::decode(frames_decoder, compression_setup::color_info, encoded);
+    ASSERT_NE(nullptr, frame);
+    double total_error = 0;
+    for(size_t i = 0; i < data.size(); i++)
+        total_error += abs(static_cast<int>(data[i]) - static_cast<int>(frame->data[i]));
+    ASSERT_LT(total_error / static_cast<double>(data.size()), 4.0);
+}
+
+GTEST_TEST(compression_tests, jpeg_raw_frame)
+{
+    //the jpeg headers exceed the size of a tiny frame, the raw frame is stored instead
+    frame_info info = {8, 8, RS_FORMAT_RGB8, 24, 3, RS_STREAM_COLOR};
+    encoder frames_encoder;
+    frames_encoder.add_codec(RS_STREAM_COLOR, RS_FORMAT_RGB8, rs::record::compression_level::high, true);
+    decoder frames_decoder({{RS_STREAM_COLOR, compression_type::jpeg}});
+
+    auto data = compression_setup::create_frame_data(info);
+    auto encoded = compression_setup::encode(frames_encoder, info, data);
+    ASSERT_EQ(data.size(), encoded.size());
+    auto frame = compression_setup::decode(frames_decoder, info, encoded);
+    ASSERT_NE(nullptr, frame);
+    ASSERT_EQ(0, memcmp(data.data(), frame->data, data.size()));
+}
+
+GTEST_TEST(compression_tests, lossless_color_by_default)
+{
+    encoder frames_encoder;
+    frames_encoder.add_codec(RS_STREAM_COLOR, RS_FORMAT_RGB8, rs::record::compression_level::high);
+    frames_encoder.add_codec(RS_STREAM_INFRARED, RS_FORMAT_Y8, rs::record::compression_level::high, true);
+    //jpeg doesn't keep the alpha channel
+    frames_encoder.add_codec(RS_STREAM_COLOR_ALIGNED_TO_DEPTH, RS_FORMAT_RGBA8, rs::record::compression_level::high, true);
+    ASSERT_EQ(compression_type::lz4, frames_encoder.get_compression_type(RS_STREAM_COLOR));
+    ASSERT_EQ(compression_type::lz4, frames_encoder.get_compression_type(RS_STREAM_INFRARED));
+    ASSERT_EQ(compression_type::lz4, frames_encoder.get_compression_type(RS_STREAM_COLOR_ALIGNED_TO_DEPTH));
+}
+
+GTEST_TEST(compression_tests, adaptive_streams)
+{
+    encoder frames_encoder;
+    frames_encoder.add_codec(RS_STREAM_DEPTH, RS_FORMAT_Z16, rs::record::compression_level::adaptive);
+    frames_encoder.add_codec(RS_STREAM_COLOR, RS_FORMAT_RGB8, rs::record::compression_level::high);
+    ASSERT_TRUE(frames_encoder.is_adaptive());
+    ASSERT_TRUE(frames_encoder.is_adaptive(RS_STREAM_DEPTH));
+    ASSERT_FALSE(frames_encoder.is_adaptive(RS_STREAM_COLOR));
+    ASSERT_FALSE(frames_encoder.is_adaptive(RS_STREAM_INFRARED));
+
+    //the adaptive frames are lossless at any acceleration
+    frames_encoder.set_acceleration(encoder::get_max_acceleration());
+    decoder frames_decoder({{RS_STREAM_DEPTH, compression_type::z16_lz4}});
+    auto data = compression_setup::create_frame_data(compression_setup::depth_info);
+    auto encoded = compression_setup::encode(frames_encoder, compression_setup::depth_info, data);
+    auto frame = compression_setup::decode(frames_decoder, compression_setup::depth_info, encoded);
+    ASSERT_NE(nullptr, frame);
+    ASSERT_EQ(0, memcmp(data.data(), frame->data, data.size()));
+}
+
+class striped_lz4_codec_tests : public testing::Test
+{
+protected:
+    //the color frame, encoded to stripes_count stripes
+    vector<uint8_t> encode_stripes(const vector<uint8_t> & data)
+    {
+        striped_lz4_codec codec(rs::record::compression_level::high, compression_setup::stripes_count);
+        auto info = compression_setup::color_info;
+        vector<uint8_t> encoded(data.size() + striped_lz4_codec::get_max_overhead());
+        uint32_t encoded_size = 0;
+        EXPECT_EQ(status_no_error, codec.encode(info, data.data(), encoded.data(), encoded_size));
+        encoded.resize(encoded_size);
+        return encoded;
+    }
+
+    shared_ptr<frame_sample> decode_stripes(const vector<uint8_t> & encoded, uint32_t encoded_size)
+    {
+        auto frame = make_shared<frame_sample>(compression_setup::color_info, 0);
+        return m_striped_codec.decode(frame, encoded.data(), encoded_size);
+    }
+
+    void set_table_entry(vector<uint8_t> & encoded, uint32_t entry, uint32_t value)
+    {
+        memcpy(encoded.data() + entry * sizeof(uint32_t), &value, sizeof(value));
+    }
+
+    uint32_t get_table_entry(const vector<uint8_t> & encoded, uint32_t entry)
+    {
+        uint32_t value = 0;
+        memcpy(&value, encoded.data() + entry * sizeof(uint32_t), sizeof(value));
+        return value;
+    }
+
+    striped_lz4_codec m_striped_codec;
+};
+
+TEST_F(striped_lz4_codec_tests, round_trip)
+{
+    encoder frames_encoder;
+    frames_encoder.add_codec(RS_STREAM_COLOR, RS_FORMAT_RGB8, rs::record::compression_level::high, false, compression_setup::stripes_count);
+    ASSERT_EQ(compression_type::lz4_striped, frames_encoder.get_compression_type(RS_STREAM_COLOR));
+    decoder frames_decoder({{RS_STREAM_COLOR, compression_type::lz4_striped}});
+
+    auto data = compression_setup::create_frame_data(compression_setup::color_info);
+    auto encoded = compression_setup::encode(frames_encoder, compression_setup::color_info, data);
+    ASSERT_LT(encoded.size(), data.size());
+    ASSERT_EQ(compression_setup::stripes_count, get_table_entry(encoded, 0));
+
+    auto frame = compression_setup::decode(frames_decoder, compression_setup::color_info, encoded);
+    ASSERT_NE(nullptr, frame);
+    ASSERT_EQ(0, memcmp(data.data(), frame->data, data.size()));
+}
+
+TEST_F(striped_lz4_codec_tests, single_stripe)
+{
+    striped_lz4_codec codec(rs::record::compression_level::high, 1);
+    auto info = compression_setup::color_info;
+    auto data = compression_setup::create_frame_data(info);
+    vector<uint8_t> encoded(data.size() + striped_lz4_codec::get_max_overhead());
+    uint32_t encoded_size = 0;
+    ASSERT_EQ(status_no_error, codec.encode(info, data.data(), encoded.data(), encoded_size));
+    ASSERT_EQ(1u, get_table_entry(encoded, 0));
+
+    auto frame = decode_stripes(encoded, encoded_size);
+    ASSERT_NE(nullptr, frame);
+    ASSERT_EQ(0, memcmp(data.data(), frame->data, data.size()));
+}
+
+TEST_F(striped_lz4_codec_tests, corrupt_table)
+{
+    auto data = compression_setup::create_frame_data(compression_setup::color_info);
+    auto encoded = encode_stripes(data);
+    auto encoded_size = static_cast<uint32_t>(encoded.size());
+    ASSERT_NE(nullptr, decode_stripes(encoded, encoded_size));
+    auto stripe_rows = get_table_entry(encoded, 1);
+
+    //the table is shorter than its header
+    ASSERT_EQ(nullptr, decode_stripes(encoded, 4));
+    //the table is shorter than its stripes count
+    ASSERT_EQ(nullptr, decode_stripes(encoded, 3 * sizeof(uint32_t)));
+
+    auto corrupt = encoded;
+    set_table_entry(corrupt, 0, 0);
+    ASSERT_EQ(nullptr, decode_stripes(corrupt, encoded_size));
+
+    corrupt = encoded;
+    set_table_entry(corrupt, 0, striped_lz4_codec::MAX_STRIPES_COUNT + 1);
+    ASSERT_EQ(nullptr, decode_stripes(corrupt, encoded_size));
+
+    //the stripes don't cover the frame rows
+    corrupt = encoded;
+    set_table_entry(corrupt, 1, stripe_rows - 1);
+    ASSERT_EQ(nullptr, decode_stripes(corrupt, encoded_size));
+
+    //the last stripe starts beyond the frame rows
+    corrupt = encoded;
+    set_table_entry(corrupt, 1, static_cast<uint32_t>(compression_setup::color_info.height));
+    ASSERT_EQ(nullptr, decode_stripes(corrupt, encoded_size));
+
+    //the stripe sizes exceed the encoded data
+    corrupt = encoded;
+    set_table_entry(corrupt, 2, get_table_entry(encoded, 2) + encoded_size);
+    ASSERT_EQ(nullptr, decode_stripes(corrupt, encoded_size));
+
+    //the last stripe is truncated
+    corrupt = encoded;
+    auto last_entry = compression_setup::stripes_count + 1;
+    set_table_entry(corrupt, last_entry, get_table_entry(encoded, last_entry) - 1);
+    ASSERT_EQ(nullptr, decode_stripes(corrupt, encoded_size - 1));
+}
@@ -0,0 +1,113 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2016 Intel Corporation. All Rights Reserved.
+
+#include <memory>
+#include <future>
+#include <chrono>
+
+#include "gtest/gtest.h"
+#include "decoded_frames_cache.h"
+
+using namespace std;
+using namespace rs::core::file_types;
+using namespace rs::playback;
+
+namespace cache_setup
+{
+    static const size_t frame_size = 1000;
+
+    decoded_frames_cache::frame_future create_frame(rs_stream stream, uint32_t index_in_stream)
+    {
+        frame_info info = {};
+        info.stream = stream;
+        info.index_in_stream = index_in_stream;
+        promise<shared_ptr<frame_sample>> decoded;
+        decoded.set_value(make_shared<frame_sample>(info, 0));
+        return decoded.get_future().share();
+    }
+
+    decoded_frames_cache::frame_future create_failed_frame()
+    {
+        promise<shared_ptr<frame_sample>> decoded;
+        decoded.set_value(nullptr);
+        return decoded.get_future().share();
+    }
+}
+
+GTEST_TEST(decoded_frames_cache_tests, least_recently_used_eviction)
+{
+    decoded_frames_cache cache(3 * cache_setup::frame_size);
+    for(uint32_t i = 0; i < 3; i++)
+        cache.insert(RS_STREAM_DEPTH, i, cache_setup::create_frame(RS_STREAM_DEPTH, i), cache_setup::frame_size);
+    ASSERT_EQ(3 * cache_setup::frame_size, cache.size());
+
+    //frame 0 becomes the most recently used, frame 1 is evicted by the next insert
+    auto frame = cache.get(RS_STREAM_DEPTH, 0);
+    ASSERT_TRUE(frame.valid());
+    ASSERT_EQ(0u, frame.get()->finfo.index_in_stream);
+    cache.insert(RS_STREAM_COLOR, 0, cache_setup::create_frame(RS_STREAM_COLOR, 0), cache_setup::frame_size);
+
+    ASSERT_TRUE(cache.contains(RS_STREAM_DEPTH, 0));
+    ASSERT_FALSE(cache.contains(RS_STREAM_DEPTH, 1));
+    ASSERT_TRUE(cache.contains(RS_STREAM_DEPTH, 2));
+    ASSERT_TRUE(cache.contains(RS_STREAM_COLOR, 0));
+    ASSERT_FALSE(cache.get(RS_STREAM_DEPTH, 1).valid());
+    ASSERT_EQ(3 * cache_setup::frame_size, cache.size());
+}
+
+GTEST_TEST(decoded_frames_cache_tests, size_accounting)
+{
+    decoded_frames_cache cache(3 * cache_setup::frame_size);
+    cache.insert(RS_STREAM_DEPTH, 0, cache_setup::create_frame(RS_STREAM_DEPTH, 0), cache_setup::frame_size);
+    cache.insert(RS_STREAM_DEPTH, 1, cache_setup::create_frame(RS_STREAM_DEPTH, 1), 2 * cache_setup::frame_size);
+    ASSERT_EQ(3 * cache_setup::frame_size, cache.size());
+
+    //replacing a frame releases the size of the replaced entry
+    cache.insert(RS_STREAM_DEPTH, 1, cache_setup::create_frame(RS_STREAM_DEPTH, 1), cache_setup::frame_size);
+    ASSERT_EQ(2 * cache_setup::frame_size, cache.size());
+    ASSERT_TRUE(cache.contains(RS_STREAM_DEPTH, 0));
+
+    //a frame larger than the cache is not kept and doesn't evict the cached frames
+    cache.insert(RS_STREAM_COLOR, 0, cache_setup::create_frame(RS_STREAM_COLOR, 0), 4 * cache_setup::frame_size);
+    ASSERT_FALSE(cache.contains(RS_STREAM_COLOR, 0));
+    ASSERT_EQ(2 * cache_setup::frame_size, cache.size());
+
+    //a larger frame evicts as many frames as required
+    cache.insert(RS_STREAM_COLOR, 1, cache_setup::create_frame(RS_STREAM_COLOR, 1), 3 * cache_setup::frame_size);
+    ASSERT_TRUE(cache.contains(RS_STREAM_COLOR, 1));
+    ASSERT_FALSE(cache.contains(RS_STREAM_DEPTH, 0));
+    ASSERT_FALSE(cache.contains(RS_STREAM_DEPTH, 1));
+    ASSERT_EQ(3 * cache_setup::frame_size, cache.size());
+
+    cache.clear();
+    ASSERT_EQ(0u, cache.size());
+    ASSERT_FALSE(cache.contains(RS_STREAM_COLOR, 1));
+}
+
+GTEST_TEST(decoded_frames_cache_tests, failed_decode_is_removed)
+{
+    decoded_frames_cache cache(3 * cache_setup::frame_size);
+    cache.insert(RS_STREAM_DEPTH, 0, cache_setup::create_failed_frame(), cache_setup::frame_size);
+    ASSERT_TRUE(cache.contains(RS_STREAM_DEPTH, 0));
+    ASSERT_FALSE(cache.get(RS_STREAM_DEPTH, 0).valid());
+    ASSERT_FALSE(cache.contains(RS_STREAM_DEPTH, 0));
+    ASSERT_EQ(0u, cache.size());
+}
+
+GTEST_TEST(decoded_frames_cache_tests, pending_decode_is_not_waited_for)
+{
+    decoded_frames_cache cache(3 * cache_setup::frame_size);
+    promise<shared_ptr<frame_sample>> decoded;
+    cache.insert(RS_STREAM_DEPTH, 0, decoded.get_future().share(), cache_setup::frame_size);
+
+    //the frame is returned while it is decoded, the caller waits for it
+    auto frame = cache.get(RS_STREAM_DEPTH, 0);
+    ASSERT_TRUE(frame.valid());
+    ASSERT_EQ(future_status::timeout, frame.wait_for(chrono::seconds(0)));
+
+    //the decode failed, the frame is removed once the decode completes
+    decoded.set_value(nullptr);
+    ASSERT_TRUE(cache.contains(RS_STREAM_DEPTH, 0));
+    ASSERT_FALSE(cache.get(RS_STREAM_DEPTH, 0).valid());
+    ASSERT_FALSE(cache.contains(RS_STREAM_DEPTH, 0));
+}
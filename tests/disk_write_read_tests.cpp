@@ -0,0 +1,585 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2016 Intel Corporation. All Rights Reserved.
+
+#include <stdio.h>
+#include <stddef.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <fcntl.h>
+#endif
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <thread>
+#include <map>
+#include <functional>
+
+#include "gtest/gtest.h"
+#include "disk_write.h"
+#include "disk_read_factory.h"
+
+using namespace std;
+using namespace rs::core;
+using namespace rs::core::file_types;
+
+namespace disk_setup
+{
+    static const int frames = 30;
+    static const frame_info depth_info = {64, 48, RS_FORMAT_Z16, 128, 2, RS_STREAM_DEPTH};
+    static const frame_info color_info = {64, 48, RS_FORMAT_RGB8, 192, 3, RS_STREAM_COLOR};
+    static const uint64_t frame_interval = 33333; //microseconds
+
+    static const std::string file_path = "disk_write_read_test.rssdk";
+    static const std::string config_file_path = "disk_write_read_config_test.rssdk";
+
+    static const uint32_t max_segments = 16;
+
+    std::string get_segment_path(uint32_t segment_index)
+    {
+        char index[16] = {};
+        snprintf(index, sizeof(index), "_%05u", segment_index);
+        return config_file_path.substr(0, config_file_path.find_last_of('.')) + index + ".rssdk";
+    }
+
+    bool is_file_exist(const std::string & path)
+    {
+        struct stat file_stat = {};
+        return stat(path.c_str(), &file_stat) == 0;
+    }
+
+#ifdef __linux__
+    struct timespec get_modification_time(const std::string & path)
+    {
+        struct stat file_stat = {};
+        stat(path.c_str(), &file_stat);
+        return file_stat.st_mtim;
+    }
+
+    bool set_modification_time(const std::string & path, struct timespec modification_time)
+    {
+        struct timespec times[2] = {};
+        times[0].tv_nsec = UTIME_OMIT;
+        times[1] = modification_time;
+        return utimensat(AT_FDCWD, path.c_str(), times, 0) == 0;
+    }
+#endif
+
+    uint8_t get_pixel_value(rs_stream stream, unsigned long long number, int byte_index)
+    {
+        return static_cast<uint8_t>((byte_index / 7 + number * (stream + 1)) & 0xff);
+    }
+
+    shared_ptr<sample> create_frame(frame_info info, unsigned long long number)
+    {
+        info.number = number;
+        info.time_stamp = static_cast<double>(number) * 33.3;
+        info.system_time = 1000 + static_cast<long long>(number);
+        info.framerate = 30;
+        auto frame = new frame_sample(info, number * frame_interval);
+        auto data = new uint8_t[info.stride * info.height];
+        for(int i = 0; i < info.stride * info.height; i++)
+            data[i] = get_pixel_value(info.stream, number, i);
+        frame->data = data;
+        frame->metadata[RS_FRAME_METADATA_ACTUAL_EXPOSURE] = static_cast<double>(number);
+        return shared_ptr<sample>(frame, [](sample * f) { delete[] static_cast<frame_sample*>(f)->data; delete f; });
+    }
+
+    bool is_frame_valid(const shared_ptr<frame_sample> & frame)
+    {
+        if(!frame || !frame->data) return false;
+        if(frame->metadata.at(RS_FRAME_METADATA_ACTUAL_EXPOSURE) != static_cast<double>(frame->finfo.number)) return false;
+        for(int i = 0; i < frame->finfo.stride * frame->finfo.height; i++)
+            if(frame->data[i] != get_pixel_value(frame->finfo.stream, frame->finfo.number, i)) return false;
+        return true;
+    }
+
+    rs::record::configuration create_config(const std::string & file_path)
+    {
+        rs::record::configuration config = {};
+        config.m_file_path = file_path;
+        config.m_capture_mode = rs::playback::capture_mode::synced;
+        config.m_coordinate_system = rear_default;
+        for(auto info : {depth_info, color_info})
+        {
+            stream_profile profile = {info, 30};
+            profile.info.framerate = 30;
+            config.m_stream_profiles[info.stream] = profile;
+            config.m_compression_config[info.stream] = rs::record::compression_level::high;
+        }
+        return config;
+    }
+}
+
+class disk_write_read_tests : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        rs::record::disk_write writer;
+        record(writer, disk_setup::create_config(disk_setup::file_path));
+    }
+
+    virtual void TearDown()
+    {
+        ::remove(disk_setup::file_path.c_str());
+        ::remove((disk_setup::file_path + ".idx").c_str());
+        ::remove(disk_setup::config_file_path.c_str());
+        for(uint32_t i = 0; i < disk_setup::max_segments; i++)
+            ::remove(disk_setup::get_segment_path(i).c_str());
+    }
+
+    //plays each segment of the record, returns the numbers of the played frames of each stream in all the segments
+    map<rs_stream, vector<unsigned long long>> play_segments(uint32_t & segments_count)
+    {
+        map<rs_stream, vector<unsigned long long>> numbers;
+        for(segments_count = 0; disk_setup::is_file_exist(disk_setup::get_segment_path(segments_count)); segments_count++)
+        {
+            unique_ptr<rs::playback::disk_read_interface> reader;
+            EXPECT_EQ(status_no_error, rs::playback::disk_read_factory::create_disk_read(disk_setup::get_segment_path(segments_count).c_str(), reader));
+            if(!reader) break;
+            reader->set_index_cache(false);
+            map<rs_stream, uint32_t> segment_frames;
+            for(auto & frame : play_frames(*reader))
+            {
+                numbers[frame.first].push_back(frame.second);
+                segment_frames[frame.first]++;
+            }
+            //the frames of a frameset are kept in the same segment
+            EXPECT_EQ(segment_frames[RS_STREAM_DEPTH], segment_frames[RS_STREAM_COLOR]);
+            for(auto stream : {RS_STREAM_DEPTH, RS_STREAM_COLOR})
+                EXPECT_EQ(segment_frames[stream], reader->query_number_of_frames(stream));
+        }
+        return numbers;
+    }
+
+    //the file is read as a record which wasn't finalized
+    void remove_trailer()
+    {
+        FILE * file = fopen(disk_setup::file_path.c_str(), "r+b");
+        ASSERT_NE(nullptr, file);
+        int64_t trailer_offset = 0;
+        ASSERT_EQ(0, fseek(file, offsetof(disk_format::file_header, trailer_offset), SEEK_SET));
+        ASSERT_EQ(1u, fwrite(&trailer_offset, sizeof(trailer_offset), 1, file));
+        fclose(file);
+    }
+
+    //records a frameset of the depth and color streams and a motion sample every frame interval, on_frameset is called after each frameset
+    void record(rs::record::disk_write & writer, const rs::record::configuration & config,
+                function<void(unsigned long long)> on_frameset = nullptr)
+    {
+        ASSERT_EQ(status_no_error, writer.configure(config));
+        ASSERT_TRUE(writer.start());
+        for(unsigned long long i = 0; i < disk_setup::frames; i++)
+        {
+            for(auto info : {disk_setup::depth_info, disk_setup::color_info})
+            {
+                auto frame = disk_setup::create_frame(info, i);
+                writer.record_sample(frame);
+            }
+            rs_motion_data motion = {};
+            motion.timestamp_data.source_id = RS_EVENT_IMU_GYRO;
+            motion.axes[0] = static_cast<float>(i);
+            shared_ptr<sample> motion_sample_ptr(new motion_sample(motion, i * disk_setup::frame_interval + 1));
+            writer.record_sample(motion_sample_ptr);
+            if(on_frameset) on_frameset(i);
+        }
+        writer.stop();
+        ASSERT_EQ(0u, writer.get_queue_status().queued_bytes);
+    }
+
+    //plays the file until its end, returns the stream and number of the played frames in their playing order
+    vector<pair<rs_stream, unsigned long long>> play_frames(rs::playback::disk_read_interface & reader, bool realtime = false)
+    {
+        reader.enable_stream(RS_STREAM_DEPTH, true);
+        reader.enable_stream(RS_STREAM_COLOR, true);
+        reader.enable_motions_callback(true);
+        vector<pair<rs_stream, unsigned long long>> frames;
+        map<rs_stream, unsigned long long> frames_count;
+        bool is_valid = true;
+        mutex eof_mutex;
+        condition_variable eof_cv;
+        bool is_eof = false;
+        reader.set_callback([&](shared_ptr<sample> sample)
+        {
+            if(sample->info.type != sample_type::st_image) return;
+            auto frame = dynamic_pointer_cast<frame_sample>(sample);
+            lock_guard<mutex> guard(eof_mutex);
+            //the frames are indexed in each file from its first frame
+            if(!disk_setup::is_frame_valid(frame) || frame->finfo.index_in_stream != frames_count[frame->finfo.stream])
+                is_valid = false;
+            frames_count[frame->finfo.stream]++;
+            frames.push_back(make_pair(frame->finfo.stream, frame->finfo.number));
+        });
+        reader.set_callback([&]()
+        {
+            lock_guard<mutex> guard(eof_mutex);
+            is_eof = true;
+            eof_cv.notify_one();
+        });
+        reader.set_realtime(realtime);
+        reader.resume();
+        {
+            unique_lock<mutex> guard(eof_mutex);
+            eof_cv.wait_for(guard, chrono::seconds(10), [&is_eof]() { return is_eof; });
+        }
+        reader.pause();
+        EXPECT_TRUE(is_eof);
+        EXPECT_TRUE(is_valid);
+        return frames;
+    }
+
+    //plays the file in non real time mode until its end, returns the number of played frames
+    int play(rs::playback::disk_read_interface & reader)
+    {
+        auto frames = play_frames(reader);
+        for(size_t i = 0; i < frames.size(); i++)
+            EXPECT_EQ(i / 2, frames[i].second);
+        return static_cast<int>(frames.size());
+    }
+};
+
+TEST_F(disk_write_read_tests, finalized_file)
+{
+    unique_ptr<rs::playback::disk_read_interface> reader;
+    ASSERT_EQ(status_no_error, rs::playback::disk_read_factory::create_disk_read(disk_setup::file_path.c_str(), reader));
+    reader->set_index_cache(false);
+    ASSERT_EQ(4, reader->query_file_info().version);
+    ASSERT_EQ(static_cast<uint32_t>(disk_setup::frames), reader->query_number_of_frames(RS_STREAM_DEPTH));
+    ASSERT_EQ(static_cast<uint32_t>(disk_setup::frames), reader->query_number_of_frames(RS_STREAM_COLOR));
+
+    reader->enable_stream(RS_STREAM_DEPTH, true);
+    reader->enable_stream(RS_STREAM_COLOR, true);
+    for(uint32_t index : {disk_setup::frames / 2, 0, disk_setup::frames - 1})
+    {
+        auto frames = reader->set_frame_by_index(index, RS_STREAM_DEPTH);
+        ASSERT_EQ(2u, frames.size());
+        for(auto & frame : frames)
+        {
+            ASSERT_EQ(index, frame.second->finfo.number);
+            ASSERT_EQ(index, frame.second->finfo.index_in_stream);
+            ASSERT_TRUE(disk_setup::is_frame_valid(frame.second));
+        }
+    }
+    auto frames = reader->set_frame_by_time_stamp(static_cast<uint64_t>(10 * 33.3));
+    ASSERT_EQ(2u, frames.size());
+    ASSERT_EQ(10u, frames[RS_STREAM_COLOR]->finfo.number);
+
+    reader->reset();
+    ASSERT_EQ(2 * disk_setup::frames, play(*reader));
+}
+
+TEST_F(disk_write_read_tests, file_without_trailer)
+{
+    //a record which wasn't finalized has no trailer, the samples are indexed from the file chunks
+    remove_trailer();
+
+    unique_ptr<rs::playback::disk_read_interface> reader;
+    ASSERT_EQ(status_no_error, rs::playback::disk_read_factory::create_disk_read(disk_setup::file_path.c_str(), reader));
+    reader->set_index_cache(false);
+    ASSERT_EQ(2 * disk_setup::frames, play(*reader));
+    reader.reset();
+
+    //the index cache isn't written when disabled
+    FILE * index_cache = fopen((disk_setup::file_path + ".idx").c_str(), "rb");
+    ASSERT_EQ(nullptr, index_cache);
+}
+
+TEST_F(disk_write_read_tests, decode_lookahead_changed_while_playing)
+{
+    unique_ptr<rs::playback::disk_read_interface> reader;
+    ASSERT_EQ(status_no_error, rs::playback::disk_read_factory::create_disk_read(disk_setup::file_path.c_str(), reader));
+    reader->set_index_cache(false);
+    reader->set_decode_lookahead(8, 2);
+
+    //the frames are delivered in order while the decode pool is replaced
+    atomic<bool> is_playing(true);
+    thread lookahead_thread([&reader, &is_playing]()
+    {
+        for(uint32_t i = 0; is_playing; i++)
+        {
+            reader->set_decode_lookahead(i % 3 == 0 ? 0 : 4 * (i % 3), 2);
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+    });
+    auto frames_count = play(*reader);
+    is_playing = false;
+    lookahead_thread.join();
+    ASSERT_EQ(2 * disk_setup::frames, frames_count);
+}
+
+TEST_F(disk_write_read_tests, back_pressure_policies)
+{
+    for(auto policy : {rs::record::drop_newest, rs::record::drop_oldest, rs::record::block})
+    {
+        //a budget smaller than a single frame accepts a sample only while no other sample is queued
+        auto config = disk_setup::create_config(disk_setup::config_file_path);
+        config.m_memory_budget = 1;
+        config.m_back_pressure_policy = policy;
+        rs::record::disk_write writer;
+        record(writer, config);
+
+        //a single sample is queued at a time, the largest one is a color frame
+        auto queue_status = writer.get_queue_status();
+        ASSERT_LT(queue_status.peak_queued_bytes, static_cast<uint64_t>(2 * disk_setup::color_info.stride * disk_setup::color_info.height));
+        map<rs_stream, uint64_t> frames_written;
+        uint64_t frames_dropped = 0;
+        for(auto stream : {RS_STREAM_DEPTH, RS_STREAM_COLOR})
+        {
+            auto statistics = writer.get_stream_statistics(stream);
+            ASSERT_EQ(static_cast<uint64_t>(disk_setup::frames), statistics.frames_received);
+            ASSERT_EQ(statistics.frames_received, statistics.frames_written + statistics.frames_dropped);
+            ASSERT_EQ(0u, statistics.queued_frames);
+            frames_written[stream] = statistics.frames_written;
+            frames_dropped += statistics.frames_dropped;
+        }
+        //the dropped samples include the motion samples
+        ASSERT_LE(frames_dropped, queue_status.dropped_samples);
+        if(policy == rs::record::block)
+        {
+            ASSERT_EQ(0u, queue_status.dropped_samples);
+        }
+
+        //the file holds the written frames in their recording order
+        unique_ptr<rs::playback::disk_read_interface> reader;
+        ASSERT_EQ(status_no_error, rs::playback::disk_read_factory::create_disk_read(disk_setup::config_file_path.c_str(), reader));
+        reader->set_index_cache(false);
+        map<rs_stream, vector<unsigned long long>> numbers;
+        for(auto & frame : play_frames(*reader))
+            numbers[frame.first].push_back(frame.second);
+        for(auto stream : {RS_STREAM_DEPTH, RS_STREAM_COLOR})
+        {
+            ASSERT_EQ(frames_written[stream], reader->query_number_of_frames(stream));
+            ASSERT_EQ(frames_written[stream], numbers[stream].size());
+            for(size_t i = 1; i < numbers[stream].size(); i++)
+                ASSERT_LT(numbers[stream][i - 1], numbers[stream][i]);
+        }
+    }
+}
+
+TEST_F(disk_write_read_tests, segment_duration_rollover)
+{
+    auto config = disk_setup::create_config(disk_setup::config_file_path);
+    config.m_segment_duration = 10 * disk_setup::frame_interval;
+    rs::record::disk_write writer;
+    record(writer, config);
+    ASSERT_FALSE(disk_setup::is_file_exist(disk_setup::config_file_path));
+
+    //each segment holds the frames of its duration, the segments are self contained files
+    uint32_t segments_count = 0;
+    auto numbers = play_segments(segments_count);
+    ASSERT_EQ(static_cast<uint32_t>(disk_setup::frames / 10), segments_count);
+    for(auto stream : {RS_STREAM_DEPTH, RS_STREAM_COLOR})
+    {
+        ASSERT_EQ(static_cast<size_t>(disk_setup::frames), numbers[stream].size());
+        for(size_t i = 0; i < numbers[stream].size(); i++)
+            ASSERT_EQ(i, numbers[stream][i]);
+    }
+    unique_ptr<rs::playback::disk_read_interface> reader;
+    ASSERT_EQ(status_no_error, rs::playback::disk_read_factory::create_disk_read(disk_setup::get_segment_path(1).c_str(), reader));
+    reader->set_index_cache(false);
+    reader->enable_stream(RS_STREAM_DEPTH, true);
+    reader->enable_stream(RS_STREAM_COLOR, true);
+    auto frames = reader->set_frame_by_index(0, RS_STREAM_DEPTH);
+    ASSERT_EQ(2u, frames.size());
+    ASSERT_EQ(10u, frames[RS_STREAM_DEPTH]->finfo.number);
+    ASSERT_TRUE(disk_setup::is_frame_valid(frames[RS_STREAM_DEPTH]));
+}
+
+TEST_F(disk_write_read_tests, segment_size_rollover)
+{
+    //the single file record is split to about four segments
+    struct stat file_stat = {};
+    ASSERT_EQ(0, stat(disk_setup::file_path.c_str(), &file_stat));
+    auto config = disk_setup::create_config(disk_setup::config_file_path);
+    config.m_segment_size = static_cast<uint64_t>(file_stat.st_size / 4);
+    rs::record::disk_write writer;
+    record(writer, config);
+
+    uint32_t segments_count = 0;
+    auto numbers = play_segments(segments_count);
+    ASSERT_GE(segments_count, 3u);
+    ASSERT_LT(segments_count, disk_setup::max_segments);
+    for(auto stream : {RS_STREAM_DEPTH, RS_STREAM_COLOR})
+    {
+        ASSERT_EQ(static_cast<size_t>(disk_setup::frames), numbers[stream].size());
+        for(size_t i = 0; i < numbers[stream].size(); i++)
+            ASSERT_EQ(i, numbers[stream][i]);
+    }
+}
+
+TEST_F(disk_write_read_tests, ring_dump_windows)
+{
+    //the ring keeps the last 5 frame intervals, the trigger after frameset 14 dumps them and writes 5 more intervals
+    auto config = disk_setup::create_config(disk_setup::config_file_path);
+    config.m_ring_duration = 5 * disk_setup::frame_interval;
+    rs::record::disk_write writer;
+    record(writer, config, [&writer](unsigned long long number)
+    {
+        if(number == 14)
+        {
+            EXPECT_EQ(status_no_error, writer.trigger(5 * disk_setup::frame_interval));
+        }
+    });
+
+    //the pre trigger window starts after frameset 9 motion, the post trigger window ends at frameset 19 motion
+    uint32_t segments_count = 0;
+    auto numbers = play_segments(segments_count);
+    ASSERT_EQ(1u, segments_count);
+    for(auto stream : {RS_STREAM_DEPTH, RS_STREAM_COLOR})
+    {
+        ASSERT_EQ(10u, numbers[stream].size());
+        for(size_t i = 0; i < numbers[stream].size(); i++)
+            ASSERT_EQ(10 + i, numbers[stream][i]);
+    }
+    ASSERT_EQ(0u, writer.get_queue_status().ring_bytes);
+}
+
+TEST_F(disk_write_read_tests, ring_trigger_extended)
+{
+    //a trigger before the post trigger window ends extends the window of the written file
+    auto config = disk_setup::create_config(disk_setup::config_file_path);
+    config.m_ring_duration = 5 * disk_setup::frame_interval;
+    rs::record::disk_write writer;
+    record(writer, config, [&writer](unsigned long long number)
+    {
+        if(number == 14)
+        {
+            EXPECT_EQ(status_no_error, writer.trigger(2 * disk_setup::frame_interval));
+        }
+        if(number == 15)
+        {
+            EXPECT_EQ(status_no_error, writer.trigger(5 * disk_setup::frame_interval));
+        }
+        if(number == 26)
+        {
+            //the first file is closed once the queued samples are written, the next trigger starts a new file
+            for(int i = 0; i < 1000 && writer.get_queue_status().queued_bytes > 0; i++)
+                this_thread::sleep_for(chrono::milliseconds(10));
+            EXPECT_EQ(status_no_error, writer.trigger(0));
+        }
+    });
+
+    //the second file holds the ring of the last trigger only
+    uint32_t segments_count = 0;
+    auto numbers = play_segments(segments_count);
+    ASSERT_EQ(2u, segments_count);
+    for(auto stream : {RS_STREAM_DEPTH, RS_STREAM_COLOR})
+    {
+        vector<unsigned long long> expected_numbers;
+        for(unsigned long long number = 10; number <= 20; number++)
+            expected_numbers.push_back(number);
+        for(unsigned long long number = 22; number <= 26; number++)
+            expected_numbers.push_back(number);
+        ASSERT_EQ(expected_numbers, numbers[stream]);
+    }
+}
+
+
+#ifdef __linux__
+TEST_F(disk_write_read_tests, index_cache)
+{
+    remove_trailer();
+    auto index_cache_path = disk_setup::file_path + ".idx";
+    const struct timespec index_cache_time = {1, 0};
+
+    //the index which was built from the samples is saved when the reader is destroyed
+    unique_ptr<rs::playback::disk_read_interface> reader;
+    ASSERT_EQ(status_no_error, rs::playback::disk_read_factory::create_disk_read(disk_setup::file_path.c_str(), reader));
+    ASSERT_EQ(static_cast<uint32_t>(disk_setup::frames), reader->query_number_of_frames(RS_STREAM_DEPTH));
+    reader.reset();
+    ASSERT_TRUE(disk_setup::set_modification_time(index_cache_path, index_cache_time));
+
+    //a matching index cache is loaded and isn't saved again
+    ASSERT_EQ(status_no_error, rs::playback::disk_read_factory::create_disk_read(disk_setup::file_path.c_str(), reader));
+    ASSERT_EQ(static_cast<uint32_t>(disk_setup::frames), reader->query_number_of_frames(RS_STREAM_COLOR));
+    ASSERT_EQ(2 * disk_setup::frames, play(*reader));
+    reader.reset();
+    ASSERT_EQ(index_cache_time.tv_sec, disk_setup::get_modification_time(index_cache_path).tv_sec);
+
+    //the index is built again when the record modification time changes
+    auto file_time = disk_setup::get_modification_time(disk_setup::file_path);
+    file_time.tv_sec -= 10;
+    ASSERT_TRUE(disk_setup::set_modification_time(disk_setup::file_path, file_time));
+    ASSERT_EQ(status_no_error, rs::playback::disk_read_factory::create_disk_read(disk_setup::file_path.c_str(), reader));
+    ASSERT_EQ(static_cast<uint32_t>(disk_setup::frames), reader->query_number_of_frames(RS_STREAM_DEPTH));
+    reader.reset();
+    ASSERT_NE(index_cache_time.tv_sec, disk_setup::get_modification_time(index_cache_path).tv_sec);
+    ASSERT_TRUE(disk_setup::set_modification_time(index_cache_path, index_cache_time));
+
+    //and when the record size changes, an empty chunk ends the samples indexing
+    FILE * file = fopen(disk_setup::file_path.c_str(), "ab");
+    ASSERT_NE(nullptr, file);
+    chunk_info chunk = {};
+    ASSERT_EQ(1u, fwrite(&chunk, sizeof(chunk), 1, file));
+    fclose(file);
+    ASSERT_TRUE(disk_setup::set_modification_time(disk_setup::file_path, file_time));
+    ASSERT_EQ(status_no_error, rs::playback::disk_read_factory::create_disk_read(disk_setup::file_path.c_str(), reader));
+    ASSERT_EQ(static_cast<uint32_t>(disk_setup::frames), reader->query_number_of_frames(RS_STREAM_DEPTH));
+    ASSERT_EQ(2 * disk_setup::frames, play(*reader));
+    reader.reset();
+    ASSERT_NE(index_cache_time.tv_sec, disk_setup::get_modification_time(index_cache_path).tv_sec);
+}
+#endif
+
+TEST_F(disk_write_read_tests, background_indexing)
+{
+    //the frames count of a record without a trailer is known once the samples indexing is done
+    remove_trailer();
+    unique_ptr<rs::playback::disk_read_interface> reader;
+    ASSERT_EQ(status_no_error, rs::playback::disk_read_factory::create_disk_read(disk_setup::file_path.c_str(), reader));
+    reader->set_index_cache(false);
+    uint32_t depth_frames = 0, color_frames = 0;
+    thread query_thread([&reader, &depth_frames, &color_frames]()
+    {
+        depth_frames = reader->query_number_of_frames(RS_STREAM_DEPTH);
+        color_frames = reader->query_number_of_frames(RS_STREAM_COLOR);
+    });
+    auto frames_count = play(*reader);
+    query_thread.join();
+    ASSERT_EQ(2 * disk_setup::frames, frames_count);
+    ASSERT_EQ(static_cast<uint32_t>(disk_setup::frames), depth_frames);
+    ASSERT_EQ(static_cast<uint32_t>(disk_setup::frames), color_frames);
+
+    //seeking past the indexed samples waits for the indexing
+    ASSERT_EQ(status_no_error, rs::playback::disk_read_factory::create_disk_read(disk_setup::file_path.c_str(), reader));
+    reader->set_index_cache(false);
+    reader->enable_stream(RS_STREAM_DEPTH, true);
+    reader->enable_stream(RS_STREAM_COLOR, true);
+    auto frames = reader->set_frame_by_index(disk_setup::frames - 1, RS_STREAM_COLOR);
+    ASSERT_EQ(2u, frames.size());
+    for(auto & frame : frames)
+    {
+        ASSERT_EQ(static_cast<unsigned long long>(disk_setup::frames - 1), frame.second->finfo.number);
+        ASSERT_TRUE(disk_setup::is_frame_valid(frame.second));
+    }
+    ASSERT_EQ(static_cast<uint32_t>(disk_setup::frames), reader->query_number_of_frames(RS_STREAM_COLOR));
+}
+
+TEST_F(disk_write_read_tests, playback_speed)
+{
+    unique_ptr<rs::playback::disk_read_interface> reader;
+    ASSERT_EQ(status_no_error, rs::playback::disk_read_factory::create_disk_read(disk_setup::file_path.c_str(), reader));
+    reader->set_index_cache(false);
+    ASSERT_EQ(1, reader->query_playback_speed());
+    for(double speed : {0.0, 0.05, 17.0})
+        ASSERT_FALSE(reader->set_playback_speed(speed));
+    ASSERT_EQ(1, reader->query_playback_speed());
+
+    //real time playback is paced by the capture times of the frames divided by the speed
+    auto duration = chrono::microseconds((disk_setup::frames - 1) * disk_setup::frame_interval);
+    map<double, chrono::steady_clock::duration> elapsed;
+    for(double speed : {1.0, 4.0})
+    {
+        ASSERT_TRUE(reader->set_playback_speed(speed));
+        ASSERT_EQ(speed, reader->query_playback_speed());
+        reader->reset();
+        auto start = chrono::steady_clock::now();
+        ASSERT_FALSE(play_frames(*reader, true).empty());
+        elapsed[speed] = chrono::steady_clock::now() - start;
+        ASSERT_GE(elapsed[speed], chrono::duration_cast<chrono::steady_clock::duration>(duration * 8 / 10) / speed);
+    }
+    ASSERT_LT(elapsed[4.0], elapsed[1.0] / 2);
+}
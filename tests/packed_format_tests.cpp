@@ -0,0 +1,176 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2016 Intel Corporation. All Rights Reserved.
+
+#include <vector>
+#include <memory>
+#include <limits>
+
+#include "gtest/gtest.h"
+#include "packed_format.h"
+
+using namespace std;
+using namespace rs::core::file_types;
+
+namespace packed_setup
+{
+    static const frame_info depth_info = {640, 480, RS_FORMAT_Z16, 1280, 2, RS_STREAM_DEPTH};
+    static const frame_info color_info = {640, 480, RS_FORMAT_RGB8, 1920, 3, RS_STREAM_COLOR};
+
+    shared_ptr<frame_sample> create_frame(frame_info info, unsigned long long number, uint64_t capture_time, uint64_t offset)
+    {
+        info.number = number;
+        info.time_stamp = static_cast<double>(number) * 33.3;
+        info.system_time = 1000 + static_cast<long long>(number) * 33;
+        info.framerate = 30;
+        info.time_stamp_domain = RS_TIMESTAMP_DOMAIN_CAMERA;
+        return make_shared<frame_sample>(info, capture_time, offset);
+    }
+}
+
+GTEST_TEST(packed_format_tests, varint_round_trip)
+{
+    const vector<uint64_t> values = {0, 1, 0x7f, 0x80, 0x3fff, 0x4000, 0xffffffff, numeric_limits<uint64_t>::max()};
+    vector<uint8_t> data;
+    packed::writer writer(data);
+    for(auto value : values)
+        writer.write_varint(value);
+
+    packed::reader reader(data.data(), data.size());
+    for(auto value : values)
+    {
+        uint64_t read_value = 0;
+        ASSERT_TRUE(reader.read_varint(read_value));
+        ASSERT_EQ(value, read_value);
+    }
+    ASSERT_TRUE(reader.is_end());
+}
+
+GTEST_TEST(packed_format_tests, varint_size)
+{
+    vector<uint8_t> data;
+    packed::writer writer(data);
+    writer.write_varint(0x7f);
+    ASSERT_EQ(1u, data.size());
+    writer.write_varint(0x80);
+    ASSERT_EQ(3u, data.size());
+    data.clear();
+    writer.write_varint(numeric_limits<uint64_t>::max());
+    ASSERT_EQ(10u, data.size());
+}
+
+GTEST_TEST(packed_format_tests, zigzag_round_trip)
+{
+    const vector<int64_t> values = {0, -1, 1, -64, 63, -65, 64, numeric_limits<int64_t>::min(), numeric_limits<int64_t>::max()};
+    vector<uint8_t> data;
+    packed::writer writer(data);
+    for(auto value : values)
+        writer.write_signed(value);
+
+    packed::reader reader(data.data(), data.size());
+    for(auto value : values)
+    {
+        int64_t read_value = 0;
+        ASSERT_TRUE(reader.read_signed(read_value));
+        ASSERT_EQ(value, read_value);
+    }
+    ASSERT_TRUE(reader.is_end());
+
+    //small negative values take a single byte
+    data.clear();
+    writer.write_signed(-64);
+    ASSERT_EQ(1u, data.size());
+}
+
+GTEST_TEST(packed_format_tests, truncated_varint)
+{
+    vector<uint8_t> data;
+    packed::writer writer(data);
+    writer.write_varint(0x4000);
+    data.pop_back();
+
+    packed::reader reader(data.data(), data.size());
+    uint64_t value = 0;
+    ASSERT_FALSE(reader.read_varint(value));
+
+    //a varint which doesn't terminate within 64 bits is rejected
+    vector<uint8_t> overlong(11, 0xff);
+    packed::reader overlong_reader(overlong.data(), overlong.size());
+    ASSERT_FALSE(overlong_reader.read_varint(value));
+}
+
+GTEST_TEST(packed_format_tests, delta_records_round_trip)
+{
+    vector<shared_ptr<sample>> samples;
+    uint64_t offset = 4096;
+    for(unsigned long long i = 0; i < 10; i++)
+    {
+        uint64_t capture_time = 1000000 + i * 33333;
+        samples.push_back(packed_setup::create_frame(packed_setup::depth_info, i, capture_time, offset));
+        offset += 614400;
+        samples.push_back(packed_setup::create_frame(packed_setup::color_info, i, capture_time + 10, offset));
+        offset += 921600;
+        rs_motion_data motion = {};
+        motion.timestamp_data.source_id = RS_EVENT_IMU_GYRO;
+        motion.timestamp_data.timestamp = static_cast<double>(i);
+        motion.axes[0] = static_cast<float>(i);
+        samples.push_back(make_shared<motion_sample>(motion, capture_time + 5, offset));
+        offset += sizeof(motion);
+    }
+    //capture time may go back between streams, the difference is zigzag coded
+    samples.push_back(packed_setup::create_frame(packed_setup::depth_info, 10, 1000000, offset));
+
+    vector<uint8_t> data;
+    packed::writer writer(data);
+    packed::context write_context = {};
+    for(auto & sample : samples)
+        packed::write_record(writer, sample, write_context);
+
+    packed::reader reader(data.data(), data.size());
+    packed::context read_context = {};
+    for(auto & sample : samples)
+    {
+        auto read_sample = packed::read_record(reader, read_context);
+        ASSERT_NE(nullptr, read_sample);
+        ASSERT_EQ(sample->info.type, read_sample->info.type);
+        ASSERT_EQ(sample->info.capture_time, read_sample->info.capture_time);
+        ASSERT_EQ(sample->info.offset, read_sample->info.offset);
+        if(sample->info.type == sample_type::st_image)
+        {
+            auto frame = static_pointer_cast<frame_sample>(sample);
+            auto read_frame = static_pointer_cast<frame_sample>(read_sample);
+            ASSERT_EQ(frame->finfo.stream, read_frame->finfo.stream);
+            ASSERT_EQ(frame->finfo.width, read_frame->finfo.width);
+            ASSERT_EQ(frame->finfo.height, read_frame->finfo.height);
+            ASSERT_EQ(frame->finfo.format, read_frame->finfo.format);
+            ASSERT_EQ(frame->finfo.stride, read_frame->finfo.stride);
+            ASSERT_EQ(frame->finfo.bpp, read_frame->finfo.bpp);
+            ASSERT_EQ(frame->finfo.framerate, read_frame->finfo.framerate);
+            ASSERT_EQ(frame->finfo.time_stamp_domain, read_frame->finfo.time_stamp_domain);
+            ASSERT_EQ(frame->finfo.number, read_frame->finfo.number);
+            ASSERT_EQ(frame->finfo.system_time, read_frame->finfo.system_time);
+            ASSERT_EQ(frame->finfo.time_stamp, read_frame->finfo.time_stamp);
+        }
+        else
+        {
+            auto motion = static_pointer_cast<motion_sample>(sample);
+            auto read_motion = static_pointer_cast<motion_sample>(read_sample);
+            ASSERT_EQ(motion->data.timestamp_data.source_id, read_motion->data.timestamp_data.source_id);
+            ASSERT_EQ(motion->data.timestamp_data.timestamp, read_motion->data.timestamp_data.timestamp);
+            ASSERT_EQ(motion->data.axes[0], read_motion->data.axes[0]);
+        }
+    }
+    ASSERT_TRUE(reader.is_end());
+}
+
+GTEST_TEST(packed_format_tests, truncated_record)
+{
+    vector<uint8_t> data;
+    packed::writer writer(data);
+    packed::context write_context = {};
+    packed::write_record(writer, packed_setup::create_frame(packed_setup::depth_info, 1, 1000, 0), write_context);
+
+    //the frame time stamp is the last field of the record
+    packed::reader reader(data.data(), data.size() - 1);
+    packed::context read_context = {};
+    ASSERT_EQ(nullptr, packed::read_record(reader, read_context));
+}
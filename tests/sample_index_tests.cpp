@@ -0,0 +1,126 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2016 Intel Corporation. All Rights Reserved.
+
+#include <vector>
+#include <memory>
+
+#include "gtest/gtest.h"
+#include "sample_index.h"
+
+using namespace std;
+using namespace rs::core::file_types;
+using namespace rs::playback;
+
+namespace sample_index_setup
+{
+    static const frame_info depth_info = {640, 480, RS_FORMAT_Z16, 1280, 2, RS_STREAM_DEPTH};
+    static const frame_info color_info = {640, 480, RS_FORMAT_RGB8, 1920, 3, RS_STREAM_COLOR};
+
+    //pushes a frame of each stream per time stamp, with a motion sample between them
+    void push_frames(sample_index & index, const vector<double> & time_stamps)
+    {
+        for(size_t i = 0; i < time_stamps.size(); i++)
+        {
+            uint64_t capture_time = i * 33333;
+            for(auto info : {depth_info, color_info})
+            {
+                info.number = i;
+                info.time_stamp = time_stamps[i];
+                index.push_back(make_shared<frame_sample>(info, capture_time, i * 1000));
+            }
+            rs_motion_data motion = {};
+            motion.axes[0] = static_cast<float>(i);
+            index.push_back(make_shared<motion_sample>(motion, capture_time + 1));
+        }
+    }
+}
+
+GTEST_TEST(sample_index_tests, frames_order)
+{
+    sample_index index;
+    sample_index_setup::push_frames(index, {0, 33.3, 66.6, 99.9});
+
+    ASSERT_EQ(12u, index.size());
+    ASSERT_EQ(4u, index.frames_count(RS_STREAM_DEPTH));
+    ASSERT_EQ(4u, index.frames_count(RS_STREAM_COLOR));
+    ASSERT_EQ(0u, index.frames_count(RS_STREAM_INFRARED));
+    ASSERT_EQ(RS_STREAM_COUNT, index.stream(2));
+    ASSERT_EQ(sample_type::st_motion, index.type(2));
+
+    for(uint32_t i = 0; i < 4; i++)
+    {
+        auto sample_index = index.frame_sample_index(RS_STREAM_COLOR, i);
+        ASSERT_EQ(i * 3 + 1, sample_index);
+        auto frame = dynamic_pointer_cast<frame_sample>(index.at(sample_index));
+        ASSERT_NE(nullptr, frame);
+        ASSERT_EQ(RS_STREAM_COLOR, frame->finfo.stream);
+        ASSERT_EQ(i, frame->finfo.index_in_stream);
+        ASSERT_EQ(i, frame->finfo.number);
+        ASSERT_EQ(sample_index_setup::color_info.format, frame->finfo.format);
+        ASSERT_EQ(sample_index_setup::color_info.stride, frame->finfo.stride);
+        ASSERT_EQ(i * 1000u, frame->info.offset);
+    }
+    auto motion = dynamic_pointer_cast<motion_sample>(index.at(5));
+    ASSERT_NE(nullptr, motion);
+    ASSERT_EQ(1.0f, motion->data.axes[0]);
+}
+
+GTEST_TEST(sample_index_tests, format_change)
+{
+    sample_index index;
+    auto info = sample_index_setup::depth_info;
+    for(uint32_t i = 0; i < 6; i++)
+    {
+        if(i == 3)
+        {
+            info.width = 320;
+            info.height = 240;
+            info.stride = 640;
+        }
+        info.number = i;
+        index.push_back(make_shared<frame_sample>(info, i * 33333));
+    }
+    for(uint32_t i = 0; i < 6; i++)
+    {
+        auto frame = dynamic_pointer_cast<frame_sample>(index.at(index.frame_sample_index(RS_STREAM_DEPTH, i)));
+        ASSERT_EQ(i < 3 ? 640 : 320, frame->finfo.width);
+        ASSERT_EQ(i < 3 ? 1280 : 640, frame->finfo.stride);
+    }
+}
+
+GTEST_TEST(sample_index_tests, find_frame_by_sample_index)
+{
+    sample_index index;
+    sample_index_setup::push_frames(index, {0, 33.3, 66.6, 99.9});
+
+    ASSERT_EQ(0u, index.find_frame_by_sample_index(RS_STREAM_DEPTH, 0));
+    ASSERT_EQ(1u, index.find_frame_by_sample_index(RS_STREAM_DEPTH, 1));
+    ASSERT_EQ(1u, index.find_frame_by_sample_index(RS_STREAM_DEPTH, 3));
+    ASSERT_EQ(2u, index.find_frame_by_sample_index(RS_STREAM_COLOR, 5));
+    ASSERT_EQ(4u, index.find_frame_by_sample_index(RS_STREAM_DEPTH, 10));
+}
+
+GTEST_TEST(sample_index_tests, find_frame_by_sorted_time_stamp)
+{
+    sample_index index;
+    sample_index_setup::push_frames(index, {10, 20, 30, 40, 50});
+
+    ASSERT_EQ(0u, index.find_frame_by_time_stamp(RS_STREAM_DEPTH, 0));
+    ASSERT_EQ(0u, index.find_frame_by_time_stamp(RS_STREAM_DEPTH, 10));
+    ASSERT_EQ(2u, index.find_frame_by_time_stamp(RS_STREAM_DEPTH, 25));
+    ASSERT_EQ(4u, index.find_frame_by_time_stamp(RS_STREAM_COLOR, 50));
+    ASSERT_EQ(5u, index.find_frame_by_time_stamp(RS_STREAM_COLOR, 51));
+}
+
+GTEST_TEST(sample_index_tests, find_frame_by_unsorted_time_stamp)
+{
+    //the device time stamps were reset along the file, bisection would miss the frames before the reset
+    sample_index index;
+    sample_index_setup::push_frames(index, {100, 110, 120, 5, 15, 25});
+
+    ASSERT_EQ(0u, index.find_frame_by_time_stamp(RS_STREAM_DEPTH, 50));
+    ASSERT_EQ(1u, index.find_frame_by_time_stamp(RS_STREAM_DEPTH, 105));
+    ASSERT_EQ(2u, index.find_frame_by_time_stamp(RS_STREAM_DEPTH, 120));
+    ASSERT_EQ(6u, index.find_frame_by_time_stamp(RS_STREAM_DEPTH, 121));
+    ASSERT_EQ(0u, index.find_frame_by_time_stamp(RS_STREAM_COLOR, 0));
+}
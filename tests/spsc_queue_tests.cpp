@@ -0,0 +1,83 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2016 Intel Corporation. All Rights Reserved.
+
+#include <memory>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "spsc_queue.h"
+
+using namespace std;
+using namespace rs::core;
+
+GTEST_TEST(spsc_queue_tests, bounded_capacity)
+{
+    //the capacity is rounded up to a power of two
+    spsc_queue<int> queue(3);
+    ASSERT_TRUE(queue.empty());
+    ASSERT_EQ(nullptr, queue.front());
+    for(int i = 0; i < 4; i++)
+        ASSERT_TRUE(queue.try_push(int(i)));
+    ASSERT_FALSE(queue.try_push(4));
+
+    for(int i = 0; i < 4; i++)
+    {
+        ASSERT_NE(nullptr, queue.front());
+        ASSERT_EQ(i, *queue.front());
+        queue.pop();
+    }
+    ASSERT_TRUE(queue.empty());
+
+    //the indices wrap around the items
+    for(int i = 0; i < 10; i++)
+    {
+        ASSERT_TRUE(queue.try_push(int(i)));
+        ASSERT_EQ(i, *queue.front());
+        queue.pop();
+    }
+    ASSERT_TRUE(queue.empty());
+}
+
+GTEST_TEST(spsc_queue_tests, pop_releases_item)
+{
+    spsc_queue<shared_ptr<int>> queue(2);
+    auto item = make_shared<int>(1);
+    weak_ptr<int> weak_item = item;
+    ASSERT_TRUE(queue.try_push(move(item)));
+    ASSERT_FALSE(weak_item.expired());
+    queue.pop();
+    ASSERT_TRUE(weak_item.expired());
+}
+
+GTEST_TEST(spsc_queue_tests, producer_consumer_threads)
+{
+    const int items_count = 100000;
+    spsc_queue<int> queue(64);
+    thread producer([&queue, items_count]()
+    {
+        for(int i = 0; i < items_count; i++)
+        {
+            while(!queue.try_push(int(i)))
+                this_thread::yield();
+        }
+    });
+
+    //the producer is joined before the results are asserted
+    int expected = 0;
+    bool is_ordered = true;
+    while(expected < items_count)
+    {
+        auto item = queue.front();
+        if(!item)
+        {
+            this_thread::yield();
+            continue;
+        }
+        is_ordered = is_ordered && *item == expected;
+        queue.pop();
+        expected++;
+    }
+    producer.join();
+    ASSERT_TRUE(is_ordered);
+    ASSERT_TRUE(queue.empty());
+}